@@ -0,0 +1,289 @@
+/*
+ *   Copyright (c) 2026 by Thomas A. Early N7TAE
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <nlohmann/json.hpp>
+#include <getopt.h>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "dht-values.h"
+#include "dht-helpers.h"
+#include "dht-json.h"
+
+// Times a batch dump of mrefd reflectors, like dht-get writes when it is given several names
+// or reads them from stdin with '-', three ways:
+// the ostream printers that dht-helpers.cpp had before CJsonWriter, an nlohmann::json
+// document that is dumped, and the Print* functions with a CJsonWriter.
+// All three write into memory, so only the formatting is timed.
+// Single runs are noisy, so each way is run many times, interleaved with the others so they
+// all see the same machine, and the median is reported along with the range.
+
+using Clock = std::chrono::steady_clock;
+using json = nlohmann::json;
+
+struct SReflector
+{
+	SMrefdConfig1 config;
+	SMrefdPeers1 peers;
+	SMrefdClients1 clients;
+	SMrefdUsers1 users;
+};
+
+static std::vector<SReflector> MakeReflectors(unsigned n, unsigned items)
+{
+	std::vector<SReflector> refs(n);
+	for (unsigned i=0; i<n; i++)
+	{
+		auto &r = refs[i];
+		const std::time_t t = 1700000000 + i;
+		r.config.timestamp = t;
+		r.config.callsign.assign("M17-" + std::to_string(100 + i % 900));
+		r.config.ipv4addr.assign("44.46.48." + std::to_string(i % 250));
+		r.config.ipv6addr.assign("2001:db8::" + std::to_string(i % 9999));
+		r.config.modules.assign("ABCDEFGH");
+		r.config.encryptedmods.assign("H");
+		r.config.url.assign("https://m17-" + std::to_string(i) + ".example.net/dashboard");
+		r.config.email.assign("sysop@example.net");
+		r.config.sponsor.assign("The Example Amateur Radio Club");
+		r.config.country.assign("US");
+		r.config.version.assign("1.1.0");
+		r.config.port = 17000;
+		r.peers.timestamp = r.clients.timestamp = r.users.timestamp = t;
+		r.peers.sequence = r.clients.sequence = r.users.sequence = 0;
+		for (unsigned j=0; j<items; j++)
+		{
+			r.peers.list.emplace_back("M17-" + std::to_string(100 + (i + j) % 900), "ABC", t - 3600 + j);
+			r.clients.list.emplace_back("N0CALL " + std::to_string(j % 10), "192.0.2." + std::to_string(j % 250), char('A' + j % 8), t - 600 + j, t - j);
+			r.users.list.emplace_back("N0CALL", "M17-" + std::to_string(100 + j % 900) + " A", r.config.callsign + " A", t - j);
+		}
+	}
+	return refs;
+}
+
+///////////////// the ostream printers from before CJsonWriter /////////////////
+
+static const char *OldTimeString(const std::time_t tt)
+{
+	static char str[32];
+	strftime(str, 32, "%FT%TZ", gmtime(&tt));
+	return str;
+}
+
+static void OldPrint(const SReflector &r, std::ostream &stream)
+{
+	const auto &c = r.config;
+	stream << "{\"Configuration\":{"
+		<< "\"Callsign\":\""    << c.callsign      << "\","
+		<< "\"Version\":\""     << c.version       << "\","
+		<< "\"Modules\":\""     << c.modules       << "\","
+		<< "\"EncryptMods\":\"" << c.encryptedmods << "\","
+		<< "\"IPv4Address\":\"" << c.ipv4addr      << "\","
+		<< "\"IPv6Address\":\"" << c.ipv6addr      << "\","
+		<< "\"URL\":\""         << c.url           << "\","
+		<< "\"Country\":\""     << c.country       << "\","
+		<< "\"Sponsor\":\""     << c.sponsor       << "\","
+		<< "\"Email\":\""       << c.email         << "\","
+		<< "\"Port\":"          << c.port          << "},";
+	stream << "\"Peers\":[";
+	for (auto pit = r.peers.list.cbegin(); pit != r.peers.list.cend(); )
+	{
+		stream <<
+			"{\"Callsign\":\""   << std::get<toUType(EMrefdPeerFields::Callsign)>(*pit) << "\"," <<
+			"\"Modules\":\""     << std::get<toUType(EMrefdPeerFields::Modules)>(*pit)  << "\"," <<
+			"\"ConnectTime\":\"" << OldTimeString(std::get<toUType(EMrefdPeerFields::ConnectTime)>(*pit)) << "\"}";
+		if (++pit != r.peers.list.cend())
+			stream << ',';
+	}
+	stream << "],\"Clients\":[";
+	for (auto cit = r.clients.list.cbegin(); cit != r.clients.list.cend(); )
+	{
+		stream <<
+			"{\"Module\":\""       << std::get<toUType(EMrefdClientFields::Module)>(*cit)   << "\"," <<
+			"\"Callsign\":\""      << std::get<toUType(EMrefdClientFields::Callsign)>(*cit) << "\"," <<
+			"\"IP\":\""            << std::get<toUType(EMrefdClientFields::Ip)>(*cit)       << "\"," <<
+			"\"ConnectTime\":\""   << OldTimeString(std::get<toUType(EMrefdClientFields::ConnectTime)>(*cit))   << "\"," <<
+			"\"LastHeardTime\":\"" << OldTimeString(std::get<toUType(EMrefdClientFields::LastHeardTime)>(*cit)) << "\"}";
+		if (++cit != r.clients.list.cend())
+			stream << ',';
+	}
+	stream << "],\"Users\":[";
+	for (auto uit = r.users.list.cbegin(); uit != r.users.list.cend(); )
+	{
+		stream <<
+			"{\"Source\":\""       << std::get<toUType(EMrefdUserFields::Source)>(*uit)      << "\"," <<
+			"\"Destination\":\""   << std::get<toUType(EMrefdUserFields::Destination)>(*uit) << "\"," <<
+			"\"Reflector\":\""     << std::get<toUType(EMrefdUserFields::Reflector)>(*uit)   << "\"," <<
+			"\"LastHeardTime\":\"" << OldTimeString(std::get<toUType(EMrefdUserFields::LastHeardTime)>(*uit)) << "\"}";
+		if (++uit != r.users.list.cend())
+			stream << ',';
+	}
+	stream << "]}\n";
+}
+
+///////////////// the same document built with nlohmann::json /////////////////
+
+static void NlohmannPrint(const SReflector &r, std::string &out)
+{
+	const auto &c = r.config;
+	json j;
+	j["Configuration"] = {
+		{ "Callsign", c.callsign }, { "Version", c.version }, { "Modules", c.modules },
+		{ "EncryptMods", c.encryptedmods }, { "IPv4Address", c.ipv4addr }, { "IPv6Address", c.ipv6addr },
+		{ "URL", c.url }, { "Country", c.country }, { "Sponsor", c.sponsor }, { "Email", c.email }, { "Port", c.port }
+	};
+	auto &peers = j["Peers"] = json::array();
+	for (const auto &p : r.peers.list)
+		peers.push_back({ { "Callsign", std::get<0>(p) }, { "Modules", std::get<1>(p) }, { "ConnectTime", OldTimeString(std::get<2>(p)) } });
+	auto &clients = j["Clients"] = json::array();
+	for (const auto &cl : r.clients.list)
+		clients.push_back({ { "Module", std::string(1, std::get<2>(cl)) }, { "Callsign", std::get<0>(cl) }, { "IP", std::get<1>(cl) },
+			{ "ConnectTime", OldTimeString(std::get<3>(cl)) }, { "LastHeardTime", OldTimeString(std::get<4>(cl)) } });
+	auto &users = j["Users"] = json::array();
+	for (const auto &u : r.users.list)
+		users.push_back({ { "Source", std::get<0>(u) }, { "Destination", std::get<1>(u) }, { "Reflector", std::get<2>(u) }, { "LastHeardTime", OldTimeString(std::get<3>(u)) } });
+	out.append(j.dump());
+	out.push_back('\n');
+}
+
+///////////////// the Print* functions with a CJsonWriter /////////////////
+
+static void WriterPrint(const SReflector &r, CJsonWriter &w)
+{
+	w.BeginObject();
+	PrintMrefdConfig(r.config, w);
+	PrintMrefdPeers(r.peers, false, w);
+	PrintMrefdClients(r.clients, false, w);
+	PrintMrefdUsers(r.users, false, w);
+	w.EndObject().EndLine();
+}
+
+// the MB/s of every run of one way of writing the batch
+struct STimes
+{
+	std::vector<double> mbs;
+	std::size_t bytes = 0; // the size of one batch
+
+	double Median() const
+	{
+		auto v = mbs;
+		std::sort(v.begin(), v.end());
+		const auto m = v.size() / 2;
+		return (v.size() % 2) ? v[m] : (v[m-1] + v[m]) / 2.0;
+	}
+	double Min() const { return *std::min_element(mbs.begin(), mbs.end()); }
+	double Max() const { return *std::max_element(mbs.begin(), mbs.end()); }
+};
+
+// one run, writing the batch 'passes' times
+template <typename F> static void Time(unsigned passes, STimes &times, F batch)
+{
+	const auto start = Clock::now();
+	for (unsigned p=0; p<passes; p++)
+		times.bytes = batch();
+	const double secs = std::chrono::duration<double>(Clock::now() - start).count();
+	times.mbs.push_back(double(times.bytes) * passes / secs / 1e6);
+}
+
+static void Report(const char *what, const STimes &times)
+{
+	std::cout << what << times.Median() << " MB/s median, " << times.Min() << " to " << times.Max() << ", " << times.bytes << " bytes" << std::endl;
+}
+
+static void Usage(std::ostream &ostr, const char *comname)
+{
+	ostr << "Usage: " << comname << " [-n reflectors] [-p passes] [-r runs] [-l items]\n"
+	<< "-n  How many reflectors are in a batch, default is 500.\n"
+	<< "-p  How many times the batch is written in each run, default is 20.\n"
+	<< "-r  How many runs of each way, the median is reported, default is 15.\n"
+	<< "-l  How many peers, clients and users each reflector has, default is 20.\n";
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned n = 500, passes = 20, runs = 15, items = 20;
+	while (1)
+	{
+		int c = getopt(argc, argv, "n:p:r:l:h");
+		if (c < 0)
+			break;
+
+		switch (c)
+		{
+			case 'n':
+			n = std::strtoul(optarg, nullptr, 10);
+			break;
+
+			case 'p':
+			passes = std::strtoul(optarg, nullptr, 10);
+			break;
+
+			case 'r':
+			runs = std::strtoul(optarg, nullptr, 10);
+			break;
+
+			case 'l':
+			items = std::strtoul(optarg, nullptr, 10);
+			break;
+
+			default:
+			Usage(std::cerr, argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+	if (0 == n || 0 == passes || 0 == runs)
+	{
+		Usage(std::cerr, argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	const auto refs = MakeReflectors(n, items);
+	STimes old, nl, writer;
+	for (unsigned r=0; r<runs; r++)
+	{
+		Time(passes, old, [&refs]() {
+			std::ostringstream ss;
+			for (const auto &r : refs)
+				OldPrint(r, ss);
+			return ss.str().size();
+		});
+		Time(passes, nl, [&refs]() {
+			std::string out;
+			for (const auto &r : refs)
+				NlohmannPrint(r, out);
+			return out.size();
+		});
+		Time(passes, writer, [&refs]() {
+			CJsonWriter w;
+			for (const auto &r : refs)
+				WriterPrint(r, w);
+			return w.Buffer().size();
+		});
+	}
+
+	std::cout << "a batch of " << n << " reflectors with " << items << " peers, clients and users each, " << runs << " runs of " << passes << " batches" << std::endl;
+	Report("ostream     ", old);
+	Report("nlohmann    ", nl);
+	Report("CJsonWriter ", writer);
+	std::cout << "CJsonWriter / ostream, median: " << writer.Median() / old.Median() << "x" << std::endl;
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,178 @@
+/*
+ *   Copyright (c) 2026 by Thomas A. Early N7TAE
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <opendht.h>
+#include <getopt.h>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "dht-values.h"
+#include "dht-views.h"
+
+// Times Value::unpack<T>() against the views in dht-views.h on the same values.
+// Both read the fields a bulk scan looks at, so the difference is the decoding.
+
+using Clock = std::chrono::steady_clock;
+
+static volatile std::size_t sink; // so the reads can't be optimized away
+
+template <typename T> static dht::Value Pack(const T &part, const char *user_type)
+{
+	msgpack::sbuffer buf;
+	msgpack::pack(buf, part);
+	dht::Value v;
+	v.user_type.assign(user_type);
+	v.data.assign(buf.data(), buf.data() + buf.size());
+	return v;
+}
+
+static std::vector<dht::Value> MakeConfigs(unsigned n)
+{
+	std::vector<dht::Value> values;
+	for (unsigned i=0; i<n; i++)
+	{
+		SMrefdConfig1 c;
+		c.timestamp = 1700000000 + i;
+		c.callsign.assign("M17-" + std::to_string(100 + i % 900));
+		c.ipv4addr.assign("44.46.48." + std::to_string(i % 250));
+		c.ipv6addr.assign("2001:db8::" + std::to_string(i % 9999));
+		c.modules.assign("ABCDEFGHIJKLMNOPQRSTUVWXYZ");
+		c.encryptedmods.assign("XYZ");
+		c.url.assign("https://m17-" + std::to_string(i) + ".example.net/dashboard");
+		c.email.assign("sysop@example.net");
+		c.sponsor.assign("The Example Amateur Radio Club");
+		c.country.assign("US");
+		c.version.assign("1.1.0");
+		c.port = 17000;
+		values.push_back(Pack(c, MREFD_CONFIG_1));
+	}
+	return values;
+}
+
+static std::vector<dht::Value> MakePeers(unsigned n, unsigned peers)
+{
+	std::vector<dht::Value> values;
+	for (unsigned i=0; i<n; i++)
+	{
+		SMrefdPeers1 p;
+		p.timestamp = 1700000000 + i;
+		p.sequence = i;
+		for (unsigned j=0; j<peers; j++)
+			p.list.emplace_back("M17-" + std::to_string(100 + (i + j) % 900), "ABC", 1700000000 + j);
+		values.push_back(Pack(p, MREFD_PEERS_1));
+	}
+	return values;
+}
+
+// nanoseconds for each value, the best of three passes
+template <typename F> static double Time(const std::vector<dht::Value> &values, unsigned passes, F read)
+{
+	double best = 0.0;
+	for (unsigned t=0; t<3; t++)
+	{
+		const auto start = Clock::now();
+		for (unsigned p=0; p<passes; p++)
+		{
+			for (const auto &v : values)
+				read(v);
+		}
+		const double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / (double(passes) * values.size());
+		if (0 == t || ns < best)
+			best = ns;
+	}
+	return best;
+}
+
+static void Report(const char *what, double unpack, double view)
+{
+	std::cout << what << ": unpack " << unpack << " ns, view " << view << " ns, " << unpack / view << "x" << std::endl;
+}
+
+static void Usage(std::ostream &ostr, const char *comname)
+{
+	ostr << "Usage: " << comname << " [-n values] [-p passes] [-l peers]\n"
+	<< "-n  How many values of each kind, default is 1000.\n"
+	<< "-p  How many times each value is read, default is 100.\n"
+	<< "-l  How many peers are in each Peers value, default is 20.\n";
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned n = 1000, passes = 100, peers = 20;
+	while (1)
+	{
+		int c = getopt(argc, argv, "n:p:l:h");
+		if (c < 0)
+			break;
+
+		switch (c)
+		{
+			case 'n':
+			n = std::strtoul(optarg, nullptr, 10);
+			break;
+
+			case 'p':
+			passes = std::strtoul(optarg, nullptr, 10);
+			break;
+
+			case 'l':
+			peers = std::strtoul(optarg, nullptr, 10);
+			break;
+
+			default:
+			Usage(std::cerr, argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+	if (0 == n || 0 == passes)
+	{
+		Usage(std::cerr, argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	const auto configs = MakeConfigs(n);
+	const auto peervalues = MakePeers(n, peers);
+	std::cout << n << " values of each kind, each read " << passes << " times, the time is for each value" << std::endl;
+
+	Report("mrefd config",
+		Time(configs, passes, [](const dht::Value &v) {
+			auto c = dht::Value::unpack<SMrefdConfig1>(v);
+			sink = sink + c.callsign.size() + c.version.size() + c.modules.size() + c.port;
+		}),
+		Time(configs, passes, [](const dht::Value &v) {
+			CMrefdConfig1View c(v);
+			if (c.IsValid())
+				sink = sink + c.Callsign().size() + c.Version().size() + c.Modules().size() + c.Port();
+		}));
+
+	Report("mrefd peers",
+		Time(peervalues, passes, [](const dht::Value &v) {
+			auto p = dht::Value::unpack<SMrefdPeers1>(v);
+			for (const auto &t : p.list)
+				sink = sink + std::get<toUType(EMrefdPeerFields::Callsign)>(t).size() + std::get<toUType(EMrefdPeerFields::Modules)>(t).size();
+		}),
+		Time(peervalues, passes, [](const dht::Value &v) {
+			CMrefdPeers1View p(v);
+			for (const auto &t : p.List())
+				sink = sink + t.Callsign().size() + t.Modules().size();
+		}));
+
+	return EXIT_SUCCESS;
+}
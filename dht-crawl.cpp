@@ -0,0 +1,190 @@
+/*
+ *   Copyright (c) 2026 by Thomas A. Early N7TAE
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <iostream>
+
+#include "dht-crawl.h"
+#include "dht-stats.h"
+
+static void Trim(std::string &s)
+{
+	while (! s.empty())
+	{
+		if (isspace(s.at(0)))
+			s.erase(0, 1);
+		else if (isspace(s.back()))
+		{
+			s.resize(s.size()-1);
+		}
+		else
+			break;
+	}
+}
+
+CCrawler::CCrawler(dht::DhtRunner &n, CVerifier &ver, const char mod, const bool m17, const unsigned win)
+	: node(n), verifier(ver), module(mod), isM17(m17), window(win ? win : 1), inflight(0), issued(0), limited(ECrawlLimit::none), stopped(false)
+{
+	w.id(isM17 ? toUType(EMrefdValueID::Peers) : toUType(EUrfdValueID::Peers));
+}
+
+void CCrawler::Run(const std::string &seed)
+{
+	const auto deadline = std::chrono::steady_clock::now() + limits.deadline;
+	std::unique_lock<std::mutex> lck(mtx);
+	seen.insert(seed);
+	queue.emplace_back(seed, 0);
+	if (onfound)
+		onfound(seed);
+
+	while (inflight || ! queue.empty())
+	{
+		if (limits.deadline.count() && std::chrono::steady_clock::now() >= deadline)
+		{
+			limited = ECrawlLimit::deadline;
+			break;
+		}
+		if (issued >= limits.maxnodes && ! queue.empty())
+		{
+			// nothing more will be requested, but what's in flight is still wanted
+			if (ECrawlLimit::none == limited)
+				limited = ECrawlLimit::nodes;
+			if (0 == inflight)
+				break;
+		}
+		if (queue.empty() || inflight >= window || issued >= limits.maxnodes)
+		{
+			// woken by Merge() when a get completes
+			if (limits.deadline.count())
+				cv.wait_until(lck, deadline);
+			else
+				cv.wait(lck);
+			continue;
+		}
+		const auto item = queue.front();
+		queue.pop_front();
+		inflight++;
+		issued++;
+
+		lck.unlock();
+		Get(item.first, item.second);
+		lck.lock();
+	}
+	stopped = true;
+}
+
+void CCrawler::Get(const std::string &refcs, unsigned depth, unsigned attempt)
+{
+	// each get has its own result, so concurrent gets can't see each other's values
+	auto result = std::make_shared<PeerResult>();
+	const auto sent = stats.Start();
+	node.get(
+		dht::InfoHash::get(refcs),
+		[this, result](const std::shared_ptr<dht::Value> &v)
+		{
+			stats.Received();
+			verifier.Check(v, [result](const std::shared_ptr<dht::Value> &v)
+			{
+				const auto start = stats.Start();
+				stats.Accepted(result->Accept(*v), start);
+			});
+			return ! stopped; // an abandoned crawl stops the search
+		},
+		[this, refcs, depth, attempt, result, sent](bool success)
+		{
+			stats.Latency(sent);
+			verifier.Then([this, refcs, depth, attempt, result, success]()
+			{
+				// the reflector is still in flight while it waits for its retry
+				const bool received = isM17 ? result->Has<SMrefdPeers1>() : result->Has<SUrfdPeers1>();
+				if (! received && ! stopped && retrier && retrier->Retry(attempt, [this, refcs, depth, attempt]() { if (! stopped) Get(refcs, depth, attempt + 1); }))
+					return;
+				if (!success && ! stopped)
+				{
+					std::cerr << "get() failed!" << std::endl;
+				}
+				Merge(refcs, depth, *result);
+			});
+		},
+		{}, // empty filter
+		w
+	);
+}
+
+SPeerList MakePeerList(const PeerResult &result, const bool isM17)
+{
+	SPeerList list;
+	auto add = [&list](std::string ref, const std::string &modules, std::time_t connect)
+	{
+		Trim(ref);
+		list.links.push_back(SPeerLink { std::move(ref), modules, connect });
+	};
+	if (isM17)
+	{
+		list.received = result.Has<SMrefdPeers1>();
+		for (const auto &p : result.Get<SMrefdPeers1>().list)
+			add(std::get<toUType(EMrefdPeerFields::Callsign)>(p), std::get<toUType(EMrefdPeerFields::Modules)>(p), std::get<toUType(EMrefdPeerFields::ConnectTime)>(p));
+	}
+	else
+	{
+		list.received = result.Has<SUrfdPeers1>();
+		for (const auto &p : result.Get<SUrfdPeers1>().list)
+			add(std::get<toUType(EUrfdPeerFields::Callsign)>(p), std::get<toUType(EUrfdPeerFields::Modules)>(p), std::get<toUType(EUrfdPeerFields::ConnectTime)>(p));
+	}
+	return list;
+}
+
+void CCrawler::Merge(const std::string &refcs, unsigned depth, const PeerResult &result)
+{
+	// add the webnode to the map
+	auto list = MakePeerList(result, isM17);
+	std::set<std::string> peerset;
+	for (const auto &l : list.links)
+	{
+		if (SharesModule(module, l.modules)) // add only if the peer is using this module
+		{
+			auto rval = peerset.insert(l.callsign);
+			if (false == rval.second)
+				std::cout << "WARNING: " << l.callsign << "could not be added to the " << refcs << (isM17 ? " mrefdPeers!" : " urfdPeers!") << std::endl;
+		}
+	}
+
+	std::lock_guard<std::mutex> lck(mtx);
+	if (stopped)
+		return;
+	// queue every peer that hasn't already been found
+	for (const auto &pstr : peerset)
+	{
+		if (depth >= limits.maxdepth)
+		{
+			// not marked as seen, a shorter path to it could still turn up
+			if (0 == seen.count(pstr))
+				limited = (ECrawlLimit::none == limited) ? ECrawlLimit::depth : limited;
+			continue;
+		}
+		if (seen.insert(pstr).second)
+		{
+			queue.emplace_back(pstr, depth + 1);
+			if (onfound)
+				onfound(pstr);
+		}
+	}
+	web.emplace(refcs, std::move(peerset));
+	links.emplace(refcs, std::move(list));
+	inflight--;
+	cv.notify_all();
+}
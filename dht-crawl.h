@@ -0,0 +1,128 @@
+/*
+ *   Copyright (c) 2026 by Thomas A. Early N7TAE
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#pragma once
+
+#include <opendht.h>
+#include <string>
+#include <set>
+#include <map>
+#include <list>
+#include <vector>
+#include <ctime>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <functional>
+#include <condition_variable>
+
+#include "dht-values.h"
+#include "dht-registry.h"
+#include "dht-retry.h"
+#include "dht-verify.h"
+
+// the peer graph of a shared module, keyed by reflector callsign
+// each item is the set of peers that reflector is sharing the module with
+using PeerWeb = std::map<std::string, std::set<std::string>>;
+
+// every peer a reflector published, on every module, whether or not the crawl followed it
+struct SPeerLink
+{
+	std::string callsign, modules;
+	std::time_t connect;
+};
+struct SPeerList
+{
+	bool received = false; // false if the reflector's Peers value never arrived
+	std::vector<SPeerLink> links;
+};
+using PeerLinks = std::map<std::string, SPeerList>;
+
+// the newest Peers values received for one reflector
+using PeerResult = CValueSet<SMrefdPeers1, SUrfdPeers1>;
+
+// the peers in the newest Peers value, with their callsigns trimmed
+extern SPeerList MakePeerList(const PeerResult &result, const bool isM17);
+// true if a peer with these modules is followed when crawling the module
+inline bool SharesModule(const char module, const std::string &modules)
+{
+	return '*' == module || std::string::npos != modules.find(module);
+}
+
+// limits on how much of the peer graph is crawled, the defaults are no limit at all
+struct SCrawlLimits
+{
+	std::chrono::milliseconds deadline { 0 };  // 0 means no deadline
+	unsigned maxnodes = UINT_MAX;              // the number of reflectors that are looked up
+	unsigned maxdepth = UINT_MAX;              // the seed is at depth 0, its peers at 1 and so on
+};
+
+// which limit cut a crawl short
+enum class ECrawlLimit { none, deadline, nodes, depth };
+
+// walks the peer graph breadth-first, keeping up to 'window' node.get()s in flight
+// each completed get is merged into the web once its values have been verified
+// a module of '*' follows the peers on every module, which crawls the whole network
+class CCrawler
+{
+public:
+	CCrawler(dht::DhtRunner &node, CVerifier &verifier, const char module, const bool isM17, const unsigned window);
+
+	void Limit(const SCrawlLimits &l) { limits = l; }
+	// a reflector whose Peers don't arrive is looked up again, until the retrier runs out of tries
+	// stop the retrier only after Run() has returned
+	void Retry(CRetrier &r) { retrier = &r; }
+
+	// blocks until every reachable reflector has been visited, or a limit is reached
+	// when the deadline passes, the lookups still in flight are abandoned and their results are ignored
+	void Run(const std::string &seed);
+	// the first limit that was reached, a reflector that wasn't looked up is never received in GetLinks()
+	ECrawlLimit Limited() const { return limited; }
+
+	// found is called once for each reflector as soon as it's discovered, starting with the seed
+	// it is called with the crawler's lock held, so it must not block
+	void OnFound(std::function<void(const std::string &)> found) { onfound = found; }
+
+	const PeerWeb &GetWeb() const { return web; }
+	const PeerLinks &GetLinks() const { return links; }
+
+private:
+	void Get(const std::string &refcs, unsigned depth, unsigned attempt = 0);
+	void Merge(const std::string &refcs, unsigned depth, const PeerResult &result);
+
+	dht::DhtRunner &node;
+	CVerifier &verifier;
+	const char module;
+	const bool isM17;
+	const unsigned window;
+	dht::Where w;
+
+	std::mutex mtx;
+	std::condition_variable cv;
+	std::list<std::pair<std::string, unsigned>> queue;  // found but not yet requested, and its depth
+	std::set<std::string> seen;    // every reflector that has been queued
+	unsigned inflight, issued;
+	SCrawlLimits limits;
+	CRetrier *retrier = nullptr;
+	ECrawlLimit limited;
+	std::atomic<bool> stopped;     // set when Run() returns, anything that arrives later is ignored
+	PeerWeb web;
+	PeerLinks links;
+	std::function<void(const std::string &)> onfound;
+};
@@ -0,0 +1,277 @@
+/*
+ *   Copyright (c) 2026 by Thomas A. Early N7TAE
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <strings.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+
+#include "dht-fetch.h"
+#include "dht-file.h"
+
+bool SValidators::Load(const std::string &path)
+{
+	std::ifstream ifs(path + ".validators");
+	url.clear();
+	etag.clear();
+	lastmodified.clear();
+	if (! std::getline(ifs, url) || ! std::getline(ifs, etag) || ! std::getline(ifs, lastmodified))
+	{
+		url.clear();
+		etag.clear();
+		return false;
+	}
+	// they are useless without the copy they describe
+	if (access(path.c_str(), R_OK))
+	{
+		url.clear();
+		return false;
+	}
+	return true;
+}
+
+bool SValidators::Save(const std::string &path) const
+{
+	const std::string text(url + '\n' + etag + '\n' + lastmodified + '\n');
+	return AtomicWrite(path + ".validators", 0644, { { text.data(), text.size() } });
+}
+
+void SValidators::Remove(const std::string &path)
+{
+	unlink((path + ".validators").c_str());
+}
+
+// the state of one mirror during a Fetch()
+struct CFetcher::STransfer
+{
+	CURL *curl;
+	const Sink *sink;
+	int *winner;    // the index of the mirror being read, or -1
+	int index;
+	bool active;    // still in the multi handle
+	bool sinkstop;  // the sink returned false
+	SValidators validators;
+};
+
+CFetcher::CFetcher(const std::string &a, long t) : agent(a), timeout(t)
+{
+	// curl_global_init() isn't thread safe, and only needs to be called once
+	static std::once_flag once;
+	std::call_once(once, []() { curl_global_init(CURL_GLOBAL_ALL); });
+	multi = curl_multi_init();
+}
+
+CFetcher::~CFetcher()
+{
+	for (auto curl : handles)
+		curl_easy_cleanup(curl);
+	if (multi)
+		curl_multi_cleanup(multi);
+}
+
+std::size_t CFetcher::Write(char *buf, std::size_t size, std::size_t nmemb, void *userp)
+{
+	auto &t = *static_cast<STransfer *>(userp);
+	const auto len = size * nmemb;
+	if (*t.winner < 0)
+	{
+		// the first mirror to send a good body wins, a file:// url has no status
+		long code = 0;
+		curl_easy_getinfo(t.curl, CURLINFO_RESPONSE_CODE, &code);
+		if (0 != code && 200 != code)
+			return 0;
+		*t.winner = t.index;
+	}
+	if (*t.winner != t.index)
+		return 0;
+	if (! (*t.sink)(buf, len))
+	{
+		t.sinkstop = true;
+		return 0;
+	}
+	return len;
+}
+
+std::size_t CFetcher::Header(char *buf, std::size_t size, std::size_t nmemb, void *userp)
+{
+	auto &t = *static_cast<STransfer *>(userp);
+	const auto len = size * nmemb;
+	std::string line(buf, len);
+	while (line.size() && ('\r' == line.back() || '\n' == line.back()))
+		line.pop_back();
+	auto value = [&line](const char *name) -> const char *
+	{
+		const auto n = strlen(name);
+		if (line.size() <= n || strncasecmp(line.c_str(), name, n))
+			return nullptr;
+		auto p = line.c_str() + n;
+		while (' ' == *p)
+			p++;
+		return p;
+	};
+	if (0 == line.compare(0, 5, "HTTP/"))
+	{
+		// a redirect, or a 100 Continue, is followed by the headers of another response
+		t.validators.etag.clear();
+		t.validators.lastmodified.clear();
+	}
+	else if (auto v = value("ETag:"))
+		t.validators.etag.assign(v);
+	else if (auto v = value("Last-Modified:"))
+		t.validators.lastmodified.assign(v);
+	return len;
+}
+
+bool CFetcher::Fetch(const std::vector<std::string> &urls, const SValidators &saved, const Sink &sink, SResult &result)
+{
+	result = SResult();
+	if (urls.empty() || nullptr == multi)
+	{
+		result.error.assign(urls.empty() ? "nothing to fetch" : "curl_multi_init() failed");
+		return false;
+	}
+
+	int winner = -1;
+	std::vector<STransfer> transfers(urls.size());
+	std::vector<curl_slist *> headers(urls.size(), nullptr);
+	while (handles.size() < urls.size())
+		handles.push_back(curl_easy_init());
+
+	for (std::size_t i=0; i<urls.size(); i++)
+	{
+		auto curl = handles[i];
+		auto &t = transfers[i];
+		t.curl = curl;
+		t.sink = &sink;
+		t.winner = &winner;
+		t.index = int(i);
+		t.active = false;
+		t.sinkstop = false;
+		if (nullptr == curl)
+			continue;
+		// a reset handle keeps its connections and dns cache
+		curl_easy_reset(curl);
+		if (saved.url == urls[i])
+		{
+			if (saved.etag.size())
+				headers[i] = curl_slist_append(headers[i], ("If-None-Match: " + saved.etag).c_str());
+			if (saved.lastmodified.size())
+				headers[i] = curl_slist_append(headers[i], ("If-Modified-Since: " + saved.lastmodified).c_str());
+		}
+		if (CURLE_OK == curl_easy_setopt(curl, CURLOPT_URL, urls[i].c_str())
+		&& CURLE_OK == curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 1L)
+		&& CURLE_OK == curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L)
+		&& CURLE_OK == curl_easy_setopt(curl, CURLOPT_TIMEOUT, timeout)
+		&& CURLE_OK == curl_easy_setopt(curl, CURLOPT_USERAGENT, agent.c_str())
+		&& CURLE_OK == curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, "") // every encoding this libcurl can decode
+		&& CURLE_OK == curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers[i])
+		&& CURLE_OK == curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, &CFetcher::Write)
+		&& CURLE_OK == curl_easy_setopt(curl, CURLOPT_WRITEDATA, &t)
+		&& CURLE_OK == curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, &CFetcher::Header)
+		&& CURLE_OK == curl_easy_setopt(curl, CURLOPT_HEADERDATA, &t)
+		&& CURLM_OK == curl_multi_add_handle(multi, curl))
+			t.active = true;
+	}
+
+	auto drop = [this](STransfer &t)
+	{
+		if (t.active)
+			curl_multi_remove_handle(multi, t.curl);
+		t.active = false;
+	};
+
+	bool done = false, ok = false;
+	int running = 1;
+	while (! done && running)
+	{
+		if (CURLM_OK != curl_multi_perform(multi, &running))
+			break;
+		int queued;
+		while (auto msg = curl_multi_info_read(multi, &queued))
+		{
+			if (CURLMSG_DONE != msg->msg)
+				continue;
+			STransfer *t = nullptr;
+			for (auto &tr : transfers)
+			{
+				if (tr.active && tr.curl == msg->easy_handle)
+					t = &tr;
+			}
+			if (nullptr == t)
+				continue;
+			long code = 0;
+			curl_easy_getinfo(t->curl, CURLINFO_RESPONSE_CODE, &code);
+			const auto rv = msg->data.result;
+			if (winner < 0 && CURLE_OK == rv && (0 == code || 200 == code || 304 == code))
+			{
+				// a 304, or a body that was empty
+				winner = t->index;
+				result.notmodified = (304 == code);
+			}
+			if (winner == t->index)
+			{
+				done = true;
+				result.url.assign(urls[t->index]);
+				if (CURLE_OK == rv)
+					ok = true;
+				else
+					result.error.assign(urls[t->index] + ": " + (t->sinkstop ? "stopped by the reader" : curl_easy_strerror(rv)));
+			}
+			else if (winner < 0)
+			{
+				// this mirror failed, the others might still answer
+				if (result.error.size())
+					result.error.append(", ");
+				result.error.append(urls[t->index] + ": ");
+				if (CURLE_OK == rv || CURLE_WRITE_ERROR == rv)
+					result.error.append("HTTP status " + std::to_string(code));
+				else
+					result.error.append(curl_easy_strerror(rv));
+			}
+			drop(*t);
+		}
+		// the mirrors that lost the race aren't needed anymore
+		if (winner >= 0)
+		{
+			for (auto &tr : transfers)
+			{
+				if (tr.index != winner)
+					drop(tr);
+			}
+		}
+		if (! done && running)
+			curl_multi_poll(multi, nullptr, 0, 1000, nullptr);
+	}
+
+	if (winner >= 0)
+	{
+		result.validators = transfers[winner].validators;
+		result.validators.url.assign(urls[winner]);
+		if (result.notmodified)
+			result.validators = saved;
+	}
+	else if (result.error.empty())
+		result.error.assign("no mirror answered");
+	for (auto &t : transfers)
+		drop(t);
+	for (auto h : headers)
+		curl_slist_free_all(h);
+	return ok;
+}
@@ -0,0 +1,77 @@
+/*
+ *   Copyright (c) 2026 by Thomas A. Early N7TAE
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#pragma once
+
+#include <curl/curl.h>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+// What a server said about the copy of a file that was saved, so the next fetch can ask
+// for the file only if it has changed. They belong to the url they came from.
+struct SValidators
+{
+	std::string url, etag, lastmodified;
+
+	// kept in '<path>.validators', next to the saved copy at 'path'
+	bool Load(const std::string &path);
+	bool Save(const std::string &path) const;
+	static void Remove(const std::string &path);
+};
+
+// Fetches a file over http(s), or anything else curl knows, with one persistent curl
+// handle for each mirror, so a later fetch reuses the connections and dns lookups of
+// the ones before it. The body is decoded from whatever compression curl supports and
+// is handed to the sink as it arrives, and the sink can stop the transfer by returning false.
+// All the mirrors are tried at the same time, and the first one to answer with the file
+// is the only one that is read, so the rest are dropped as soon as it starts.
+class CFetcher
+{
+public:
+	using Sink = std::function<bool(const char *data, std::size_t len)>;
+
+	struct SResult
+	{
+		std::string url;         // the mirror that answered
+		bool notmodified = false; // it answered 304, nothing was given to the sink
+		SValidators validators;   // what it said about the file it sent
+		std::string error;        // why nobody answered, or why the transfer failed
+	};
+
+	// timeout is in seconds, for each fetch
+	CFetcher(const std::string &agent, long timeout = 30);
+	~CFetcher();
+	CFetcher(const CFetcher &) = delete;
+	CFetcher &operator=(const CFetcher &) = delete;
+
+	// 'saved' is only sent to the mirror it came from, so only that mirror can answer 304
+	bool Fetch(const std::vector<std::string> &urls, const SValidators &saved, const Sink &sink, SResult &result);
+
+private:
+	struct STransfer;
+
+	static std::size_t Write(char *buf, std::size_t size, std::size_t nmemb, void *userp);
+	static std::size_t Header(char *buf, std::size_t size, std::size_t nmemb, void *userp);
+
+	const std::string agent;
+	const long timeout;
+	CURLM *multi = nullptr;
+	std::vector<CURL *> handles; // one for each mirror, kept between fetches
+};
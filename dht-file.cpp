@@ -0,0 +1,61 @@
+/*
+ *   Copyright (c) 2026 by Thomas A. Early N7TAE
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdio>
+
+#include "dht-file.h"
+
+// a write can be interrupted, or write less than it was asked to
+static bool WriteAll(int fd, const char *data, std::size_t len)
+{
+	while (len)
+	{
+		const auto n = write(fd, data, len);
+		if (n < 0)
+		{
+			if (EINTR == errno)
+				continue;
+			return false;
+		}
+		data += n;
+		len -= std::size_t(n);
+	}
+	return true;
+}
+
+bool AtomicWrite(const std::string &path, mode_t mode, const std::vector<SChunk> &chunks)
+{
+	const std::string tmp(path + "." + std::to_string(getpid()));
+	int fd;
+	do
+		fd = open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, mode);
+	while (fd < 0 && EINTR == errno);
+	if (fd < 0)
+		return false;
+	bool ok = true;
+	for (auto it=chunks.begin(); ok && it!=chunks.end(); it++)
+		ok = WriteAll(fd, static_cast<const char *>(it->data), it->len);
+	ok = (0 == close(fd)) && ok;
+	if (ok && 0 == rename(tmp.c_str(), path.c_str()))
+		return true;
+	unlink(tmp.c_str());
+	return false;
+}
@@ -0,0 +1,35 @@
+/*
+ *   Copyright (c) 2026 by Thomas A. Early N7TAE
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#pragma once
+
+#include <sys/types.h>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+struct SChunk
+{
+	const void *data;
+	std::size_t len;
+};
+
+// Writes the chunks, in order, to a temporary file that is then renamed to path, so a reader
+// never sees a partial file. The temporary file is named for this process, so tools that share
+// a file don't write over each other's. Returns false, and leaves path alone, on any failure.
+extern bool AtomicWrite(const std::string &path, mode_t mode, const std::vector<SChunk> &chunks);
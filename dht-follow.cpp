@@ -0,0 +1,177 @@
+/*
+ *   Copyright (c) 2026 by Thomas A. Early N7TAE
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <set>
+#include <vector>
+
+#include "dht-follow.h"
+
+CPeerFollower::CPeerFollower(dht::DhtRunner &n, CVerifier &ver, const char mod, const bool m17)
+	: node(n), verifier(ver), module(mod), isM17(m17)
+{
+	w.id(isM17 ? toUType(EMrefdValueID::Peers) : toUType(EUrfdValueID::Peers));
+}
+
+void CPeerFollower::Follow(const PeerLinks &crawled, const std::string &s)
+{
+	std::vector<std::string> refs;
+	{
+		std::lock_guard<std::mutex> lck(mtx);
+		seed = s;
+		links = crawled;
+		for (const auto &item : crawled)
+		{
+			followed.emplace(item.first, SFollowed());
+			refs.push_back(item.first);
+		}
+	}
+	// the listens deliver the current values first, which are already in the verifier's cache
+	for (const auto &refcs : refs)
+		Listen(refcs);
+}
+
+void CPeerFollower::Listen(const std::string &refcs)
+{
+	auto token = node.listen(
+		dht::InfoHash::get(refcs),
+		[this, refcs](const std::vector<std::shared_ptr<dht::Value>> &values, bool expired)
+		{
+			if (expired)
+			{
+				Expire(refcs);
+				return true;
+			}
+			for (const auto &v : values)
+				verifier.Check(v, [this, refcs](const std::shared_ptr<dht::Value> &v) { Update(refcs, *v); });
+			return true;
+		},
+		{},	// empty filter
+		w
+	).share();
+
+	std::lock_guard<std::mutex> lck(mtx);
+	auto it = followed.find(refcs);
+	// it might have been pruned while the listen was starting
+	if (stopped || followed.end() == it)
+		node.cancelListen(dht::InfoHash::get(refcs), token);
+	else
+		it->second.token = token;
+}
+
+void CPeerFollower::Update(const std::string &refcs, const dht::Value &v)
+{
+	std::vector<std::string> added;
+	{
+		std::lock_guard<std::mutex> lck(mtx);
+		// a pruned reflector's listen can still deliver a value after it is cancelled
+		auto fit = followed.find(refcs);
+		if (followed.end() == fit)
+			return;
+		auto &f = fit->second;
+		// a value that arrives late, or again, doesn't change anything
+		if (EAccept::newer != f.values.Accept(v))
+			return;
+		auto list = MakePeerList(f.values, isM17);
+		for (const auto &l : list.links)
+		{
+			if (SharesModule(module, l.modules) && 0 == followed.count(l.callsign))
+			{
+				followed.emplace(l.callsign, SFollowed());
+				added.push_back(l.callsign);
+			}
+		}
+		links[refcs] = std::move(list);
+		updates++;
+		Prune();
+		if (stopped)
+			return;
+	}
+	// a new peer is crawled simply by listening to it
+	for (const auto &refcs : added)
+		Listen(refcs);
+}
+
+void CPeerFollower::Expire(const std::string &refcs)
+{
+	std::lock_guard<std::mutex> lck(mtx);
+	// keep listening, so the reflector comes back as soon as it publishes again
+	auto it = followed.find(refcs);
+	if (followed.end() != it)
+		it->second.values = PeerResult();
+	if (links.erase(refcs))
+	{
+		updates++;
+		Prune();
+	}
+}
+
+// drop every reflector that can't be reached from the seed anymore, call this with the lock held
+void CPeerFollower::Prune()
+{
+	std::set<std::string> reached { seed };
+	std::vector<std::string> stack { seed };
+	while (! stack.empty())
+	{
+		const auto refcs = stack.back();
+		stack.pop_back();
+		auto it = links.find(refcs);
+		if (links.end() == it)
+			continue;
+		for (const auto &l : it->second.links)
+		{
+			if (SharesModule(module, l.modules) && reached.insert(l.callsign).second)
+				stack.push_back(l.callsign);
+		}
+	}
+
+	for (auto it = followed.begin(); it != followed.end(); )
+	{
+		if (reached.count(it->first))
+		{
+			++it;
+			continue;
+		}
+		if (it->second.token.valid())
+			node.cancelListen(dht::InfoHash::get(it->first), it->second.token);
+		links.erase(it->first);
+		it = followed.erase(it);
+	}
+}
+
+void CPeerFollower::Stop()
+{
+	std::lock_guard<std::mutex> lck(mtx);
+	stopped = true;
+	for (auto &item : followed)
+	{
+		if (item.second.token.valid())
+			node.cancelListen(dht::InfoHash::get(item.first), item.second.token);
+	}
+}
+
+CPeerGraph CPeerFollower::Graph()
+{
+	std::lock_guard<std::mutex> lck(mtx);
+	return CPeerGraph(links);
+}
+
+unsigned CPeerFollower::Updates()
+{
+	std::lock_guard<std::mutex> lck(mtx);
+	return updates;
+}
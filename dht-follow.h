@@ -0,0 +1,75 @@
+/*
+ *   Copyright (c) 2026 by Thomas A. Early N7TAE
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#pragma once
+
+#include <opendht.h>
+#include <future>
+#include <string>
+#include <map>
+#include <mutex>
+
+#include "dht-crawl.h"
+#include "dht-graph.h"
+#include "dht-verify.h"
+
+// Keeps the result of a crawl up to date by listening to the Peers of every reflector it found.
+// A changed Peers value replaces that reflector's links, a newly linked reflector is listened to
+// as soon as it shows up, and a reflector whose Peers value expires is dropped from the graph.
+// A reflector that can no longer be reached from the seed is dropped and no longer listened to,
+// so the graph stays what a fresh crawl would find.
+// The graph is always in memory, so Graph() needs no network traffic.
+class CPeerFollower
+{
+public:
+	CPeerFollower(dht::DhtRunner &node, CVerifier &verifier, const char module, const bool isM17);
+
+	// start with the links of a finished crawl from 'seed' and listen to every reflector in it
+	void Follow(const PeerLinks &crawled, const std::string &seed);
+	// cancel every listen, call this before node.join()
+	void Stop();
+
+	CPeerGraph Graph();
+	// the number of Peers values applied, or expired, since Follow()
+	unsigned Updates();
+
+private:
+	struct SFollowed
+	{
+		PeerResult values;
+		std::shared_future<size_t> token;
+	};
+
+	void Listen(const std::string &refcs);
+	void Update(const std::string &refcs, const dht::Value &v);
+	void Expire(const std::string &refcs);
+	void Prune();
+
+	dht::DhtRunner &node;
+	CVerifier &verifier;
+	const char module;
+	const bool isM17;
+	dht::Where w;
+
+	std::mutex mtx;
+	std::map<std::string, SFollowed> followed;
+	PeerLinks links;
+	std::string seed;
+	unsigned updates = 0;
+	bool stopped = false;
+};
@@ -0,0 +1,149 @@
+/*
+ *   Copyright (c) 2026 by Thomas A. Early N7TAE
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <opendht.h>
+#include <opendht/dht_proxy_server.h>
+#include <getopt.h>
+#include <csignal>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "dht-node.h"
+
+static const std::string default_bs("xrf757.openquad.net");
+static const std::string default_address("127.0.0.1");
+static const in_port_t default_port = 8000;
+static const long save_interval = 600; // seconds between saves of the routing table
+
+static void Usage(std::ostream &ostr, const char *comname)
+{
+	ostr << "usage: " << comname << " [-b bootstrap] [-a address] [-p port] [--identity dir | --ephemeral]" << std::endl << std::endl;
+	ostr << "Runs one long-lived Ham-DHT node that the other tools use with --gateway, so they don't" << std::endl;
+	ostr << "each start, and bootstrap, a node of their own. Stop it with Control-C." << std::endl;
+	ostr << "Options:" << std::endl;
+	ostr << "    -b (bootstrap) argument is any running node on the dht network, or a comma separated" << std::endl;
+	ostr << "       list of them, which are all tried at the same time." << std::endl;
+	ostr << "       If not specified, " << default_bs << " will be used." << std::endl;
+	ostr << "    -a the address the gateway listens on, default is " << default_address << std::endl;
+	ostr << "       Only use an address that other machines can reach if you want them to use the gateway." << std::endl;
+	ostr << "    -p the port the gateway listens on, default is " << default_port << std::endl;
+	ostr << "    --identity dir is where the node identity and routing table are saved, default is " << DefaultStateDir() << std::endl;
+	ostr << "    --ephemeral will use a new identity that isn't saved" << std::endl;
+	ostr << "The tools then use it with --gateway http://" << default_address << ':' << default_port << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+	std::string bs(default_bs);
+	dht::ProxyServerConfig proxycfg;
+	proxycfg.address = default_address;
+	proxycfg.port = default_port;
+	SNodeOptions nodeopts;
+	static const struct option long_options[] = {
+		{ "identity",  required_argument, nullptr, OPT_IDENTITY  },
+		{ "ephemeral", no_argument,       nullptr, OPT_EPHEMERAL },
+		{ "help",      no_argument,       nullptr, 'h'           },
+		{ nullptr, 0, nullptr, 0 }
+	};
+	while (1)
+	{
+		int c = getopt_long(argc, argv, "a:b:hp:", long_options, nullptr);
+		if (c < 0)
+			break;
+
+		switch (c)
+		{
+			case 'a':
+			proxycfg.address.assign(optarg);
+			break;
+
+			case 'b':
+			bs.assign(optarg);
+			break;
+
+			case 'h':
+			Usage(std::cout, argv[0]);
+			exit(EXIT_SUCCESS);
+
+			case 'p':
+			{
+				const auto port = std::strtoul(optarg, nullptr, 10);
+				if (0 == port || port > 65535)
+				{
+					std::cerr << argv[0] << ": " << optarg << " is not a port number!" << std::endl;
+					exit(EXIT_FAILURE);
+				}
+				proxycfg.port = in_port_t(port);
+			}
+			break;
+
+			case OPT_IDENTITY:
+			nodeopts.statedir.assign(optarg);
+			break;
+
+			case OPT_EPHEMERAL:
+			nodeopts.ephemeral = true;
+			break;
+
+			default:
+			Usage(std::cerr, argv[0]);
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	if (optind != argc)
+	{
+		std::cerr << argv[0] << ": Too many arguments!" << std::endl;
+		Usage(std::cerr, argv[0]);
+		exit(EXIT_FAILURE);
+	}
+
+	// block these before the node starts its threads, so only sigtimedwait() will see them
+	sigset_t sigs;
+	sigemptyset(&sigs);
+	sigaddset(&sigs, SIGINT);
+	sigaddset(&sigs, SIGTERM);
+	pthread_sigmask(SIG_BLOCK, &sigs, nullptr);
+
+	// the proxy server needs to share ownership of the node
+	auto node = std::make_shared<dht::DhtRunner>();
+	std::unique_ptr<dht::DhtProxyServer> proxy;
+	try {
+		RunNode(*node, "HamGateway", bs, nodeopts);
+		proxy.reset(new dht::DhtProxyServer(node, proxycfg));
+	} catch (const std::exception &ex) {
+		std::cerr << argv[0] << " can't start the gateway! " << ex.what() << std::endl;
+		node->join();
+		return EXIT_FAILURE;
+	}
+	std::cout << "Gateway is at http://" << proxycfg.address << ':' << proxycfg.port << std::endl;
+
+	// the routing table is saved now and then, so even a gateway that is killed restarts warm
+	const struct timespec interval { save_interval, 0 };
+	while (sigtimedwait(&sigs, nullptr, &interval) < 0)
+		SaveNodes(*node, nodeopts);
+
+	proxy.reset();
+	SaveNodes(*node, nodeopts);
+	node->join();
+
+	return EXIT_SUCCESS;
+}
@@ -17,48 +17,268 @@
  */
 
 #include <opendht.h>
+#include <getopt.h>
 #include <iostream>
 #include <iomanip>
 #include <mutex>
+#include <atomic>
+#include <list>
+#include <thread>
 #include <condition_variable>
 
 #include "dht-values.h"
 #include "dht-helpers.h"
+#include "dht-registry.h"
+#include "dht-node.h"
+#include "dht-retry.h"
+#include "dht-stats.h"
+#include "dht-window.h"
+#include "dht-verify.h"
 
-static bool running = true;
-static std::condition_variable cv;
-static std::mutex mtx;
 static char section = 'a';
 static bool use_local = false;
 static const std::string default_bs("xrf757.openquad.net");
-static dht::Where w;
-static SMrefdConfig1  mrefdConfig;
-static SMrefdPeers1   mrefdPeers;
-static SUrfdPeers1    urfdPeers;
-static SUrfdConfig1   urfdConfig;
+static const unsigned default_window = 16;
+static const unsigned default_retries = 3;
+static bool firstvalue = false;
+
+enum { OPT_FIRST = 0x200 };
 
 enum class ENodeType { urfd, mrefd };
 
+// the newest values found for one node_name
+struct SReflector
+{
+	SReflector(const std::string &k, ENodeType t) : key(k), type(t) {}
+	const std::string key;
+	const ENodeType type;
+	CValueSet<SMrefdConfig1, SMrefdPeers1, SUrfdConfig1, SUrfdPeers1> values;
+	// once complete is set, values doesn't change again, so it can be output without the lock
+	std::mutex mtx;
+	std::atomic<bool> complete { false };
+};
+
+// finished lookups waiting to be output
+static std::mutex mtx;
+static std::condition_variable cv;
+static std::list<std::shared_ptr<SReflector>> finished;
+static unsigned started = 0;
+static bool reading = true; // still issuing lookups
+
 static void Usage(std::ostream &ostr, const char *comname)
 {
-	ostr << "usage: " << comname << " [-b bootstrap] [-s {c|l|p|u}] [-l] node_name" << std::endl << std::endl;
+	ostr << "usage: " << comname << " [-b bootstrap] [-s {c|l|p|u}] [-l] [-j gets] [-t secs] [-r tries] [--first] [--stats] [--identity dir | --ephemeral] [--gateway url] node_name ..." << std::endl << std::endl;
 	ostr << "Options:" << std::endl;
-	ostr << "    -b (bootstrap) argument is any running node on the dht network" << std::endl;
+	ostr << "    -b (bootstrap) argument is any running node on the dht network, or a comma separated" << std::endl;
+	ostr << "       list of them, which are all tried at the same time." << std::endl;
 	ostr << "       If not specified, " << default_bs << " will be used." << std::endl;
 	ostr << "    -s (section) arguments is one of:" << std::endl;
 	ostr << "        c - configuration" << std::endl;
 	ostr << "        p - peer list" << std::endl;
 	ostr << "        If no section is specified, both sections will be output." << std::endl;
 	ostr << "    -l will output time values in local time, otherwise gmt is reported." << std::endl;
+	ostr << "    -j the maximum number of reflectors being looked up at once, default is " << default_window << std::endl;
+	ostr << "    -r the most times a reflector that is missing a section is looked up again, default is " << default_retries << std::endl;
+	ostr << "    -t the number of seconds to wait for a reflector before outputting what has been found" << std::endl;
+	ostr << "       so far, default is no limit" << std::endl;
+	ostr << "    --first outputs a reflector as soon as every section asked for has arrived, and cancels the" << std::endl;
+	ostr << "       rest of its search. This is much faster, but a section can be an older value that a newer" << std::endl;
+	ostr << "       one has superseded. Otherwise each search is waited for, so the newest values are output." << std::endl;
+	ostr << "More than one node_name can be given. If node_name is -, the names are read from stdin." << std::endl;
+	ostr << "With more than one node, each is output on its own line as soon as it is found, with its" << std::endl;
+	ostr << "name in a \"Designator\" field." << std::endl;
+	ostr << "    --stats outputs where the time went, and what happened to the values, as json on stderr" << std::endl;
+	NodeUsage(ostr);
 }
 
 
+
+// true once every section that was asked for has arrived, so --first can stop the search and there is nothing to retry
+static bool HasEverything(SReflector &refl)
+{
+	std::lock_guard<std::mutex> lck(refl.mtx);
+	const bool config = ('p' == section) || ((ENodeType::mrefd == refl.type) ? refl.values.Has<SMrefdConfig1>() : refl.values.Has<SUrfdConfig1>());
+	const bool peers  = ('c' == section) || ((ENodeType::mrefd == refl.type) ? refl.values.Has<SMrefdPeers1>()  : refl.values.Has<SUrfdPeers1>());
+	return config && peers;
+}
+
+// the lookup is over because everything has arrived, the search finished or the deadline passed
+// whichever comes first queues the reflector for output, and the others do nothing
+static void Complete(CLookupWindow &window, const std::shared_ptr<CLookupWindow::STicket> &ticket, const std::shared_ptr<SReflector> &refl)
+{
+	{
+		std::lock_guard<std::mutex> lck(refl->mtx);
+		if (refl->complete)
+			return;
+		refl->complete = true;
+	}
+	if (ticket)
+		window.Finish(ticket, nullptr);
+	std::lock_guard<std::mutex> lck(mtx);
+	finished.push_back(refl);
+	cv.notify_all();
+}
+
+static void Get(dht::DhtRunner &node, CVerifier &verifier, CLookupWindow &window, CRetrier &retrier, const std::shared_ptr<CLookupWindow::STicket> &ticket, const std::shared_ptr<SReflector> &refl, const dht::Where &w, unsigned attempt)
+{
+	const auto sent = stats.Start();
+	auto done = [&node, &verifier, &window, &retrier, ticket, refl, w, attempt, sent](bool success) {
+		stats.Latency(sent);
+		verifier.Then([&node, &verifier, &window, &retrier, ticket, refl, w, attempt, success]() {
+			// a lookup that is still missing a section keeps its place in the window while it waits to be retried
+			if (! refl->complete && ! HasEverything(*refl) && retrier.Retry(attempt, [&node, &verifier, &window, &retrier, ticket, refl, w, attempt]() {
+					if (! refl->complete)
+						Get(node, verifier, window, retrier, ticket, refl, w, attempt + 1);
+				}))
+				return;
+			if (! success && ! refl->complete)
+			{
+				std::cerr << "get() failed for " << refl->key << "!" << std::endl;
+			}
+			Complete(window, ticket, refl);
+		});
+	};
+
+	node.get(
+		dht::InfoHash::get(refl->key),
+		[&verifier, &window, ticket, refl](const std::shared_ptr<dht::Value> &v) {
+			stats.Received();
+			verifier.Check(v, [&window, ticket, refl](const std::shared_ptr<dht::Value> &v) {
+				{
+					std::lock_guard<std::mutex> lck(refl->mtx);
+					if (refl->complete)
+						return;
+					const auto start = stats.Start();
+					stats.Accepted(refl->values.Accept(*v), start);
+				}
+				if (firstvalue && HasEverything(*refl))
+					Complete(window, ticket, refl);
+			});
+			return ! refl->complete; // a completed lookup stops the search
+		},
+		done,
+		{},	// empty filter
+		w
+	);
+}
+
+static void Lookup(dht::DhtRunner &node, CVerifier &verifier, CLookupWindow &window, CRetrier &retrier, const std::shared_ptr<SReflector> &refl)
+{
+	dht::Where w;
+	switch (refl->type)
+	{
+		case ENodeType::mrefd:
+			switch (section)
+			{
+				case 'c':
+				w.id(toUType(EMrefdValueID::Config));
+				break;
+
+				case 'p':
+				w.id(toUType(EMrefdValueID::Peers));
+				break;
+			}
+			break;
+		case ENodeType::urfd:
+			switch (section)
+			{
+				case 'c':
+				w.id(toUType(EUrfdValueID::Config));
+				break;
+
+				case 'p':
+				w.id(toUType(EUrfdValueID::Peers));
+				break;
+			}
+			break;
+	}
+
+	auto ticket = window.Acquire([&window, refl]() { Complete(window, nullptr, refl); });
+	Get(node, verifier, window, retrier, ticket, refl, w, 0);
+}
+
+// output one reflector as a single line json object
+static void Print(const SReflector &refl, bool batch, CJsonWriter &json)
+{
+	const auto &mrefdConfig = refl.values.Get<SMrefdConfig1>();
+	const auto &mrefdPeers  = refl.values.Get<SMrefdPeers1>();
+	const auto &urfdConfig  = refl.values.Get<SUrfdConfig1>();
+	const auto &urfdPeers   = refl.values.Get<SUrfdPeers1>();
+	json.BeginObject();
+	if (batch)
+		json.Str("Designator", refl.key);
+	switch (section)
+	{
+		case 'c':
+			switch (refl.type)
+			{
+				case ENodeType::mrefd: PrintMrefdConfig(mrefdConfig, json); break;
+				case ENodeType::urfd:  PrintUrfdConfig(urfdConfig, json);  break;
+			}
+			break;
+		case 'p':
+			switch (refl.type)
+			{
+				case ENodeType::mrefd: PrintMrefdPeers(mrefdPeers, use_local, json); break;
+				case ENodeType::urfd:  PrintUrfdPeers(urfdPeers, use_local, json);  break;
+			}
+			break;
+		default:
+			switch (refl.type)
+			{
+				case ENodeType::mrefd:
+					if (mrefdConfig.timestamp)
+					{
+						PrintMrefdConfig(mrefdConfig, json);
+						PrintMrefdPeers(mrefdPeers, use_local, json);
+					}
+					break;
+				case ENodeType::urfd:
+					if (urfdConfig.timestamp)
+					{
+						PrintUrfdConfig(urfdConfig, json);
+						PrintUrfdPeers(urfdPeers, use_local, json);
+					}
+					break;
+			}
+	}
+	json.EndObject().EndLine();
+}
+
+// returns nullptr if the name isn't an M17 or URF reflector
+static std::shared_ptr<SReflector> NewReflector(std::string key)
+{
+	for (auto &c : key)
+		c = std::toupper(c);
+	if (0 == key.compare(0, 4, "M17-"))
+		return std::make_shared<SReflector>(key, ENodeType::mrefd);
+	if (0 == key.compare(0, 3, "URF"))
+		return std::make_shared<SReflector>(key, ENodeType::urfd);
+	std::cerr << "Don't know how to get '" << key << "'" << std::endl;
+	return nullptr;
+}
+
 int main(int argc, char *argv[])
 {
+	const auto start = CStats::Clock::now();
 	std::string bs(default_bs);
+	unsigned inflight = default_window;
+	unsigned tries = default_retries;
+	double timeout = 0.0;
+	SNodeOptions nodeopts;
+	static const struct option long_options[] = {
+		{ "identity",  required_argument, nullptr, OPT_IDENTITY  },
+		{ "ephemeral", no_argument,       nullptr, OPT_EPHEMERAL },
+		{ "gateway",   required_argument, nullptr, OPT_GATEWAY   },
+		{ "stats",     no_argument,       nullptr, OPT_STATS     },
+		{ "first",     no_argument,       nullptr, OPT_FIRST     },
+		{ "ready-nodes", required_argument, nullptr, OPT_READYNODES },
+		{ "ready-wait",  required_argument, nullptr, OPT_READYWAIT  },
+		{ nullptr, 0, nullptr, 0 }
+	};
 	while (1)
 	{
-		int c = getopt(argc, argv, "b:s:l");
+		int c = getopt_long(argc, argv, "b:j:r:s:lt:", long_options, nullptr);
 		if (c < 0)
 		{
 			if (1 == argc)
@@ -75,10 +295,62 @@ int main(int argc, char *argv[])
 			bs.assign(optarg);
 			break;
 
+			case OPT_STATS:
+			stats.Enable();
+			break;
+
+			case 'r':
+			tries = std::strtoul(optarg, nullptr, 10);
+			break;
+
+			case 'j':
+			inflight = std::strtoul(optarg, nullptr, 10);
+			if (0 == inflight)
+			{
+				std::cerr << argv[0] << ": " << "-j must be at least 1!" << std::endl;
+				Usage(std::cerr, argv[0]);
+				exit(EXIT_FAILURE);
+			}
+			break;
+
+			case 't':
+			timeout = std::strtod(optarg, nullptr);
+			if (timeout <= 0.0)
+			{
+				std::cerr << argv[0] << ": " << "-t must be more than 0 seconds!" << std::endl;
+				Usage(std::cerr, argv[0]);
+				exit(EXIT_FAILURE);
+			}
+			break;
+
+			case OPT_FIRST:
+			firstvalue = true;
+			break;
+
 			case 'l':
 			use_local = true;
 			break;
 
+			case OPT_IDENTITY:
+			nodeopts.statedir.assign(optarg);
+			break;
+
+			case OPT_EPHEMERAL:
+			nodeopts.ephemeral = true;
+			break;
+
+			case OPT_GATEWAY:
+			nodeopts.gateway.assign(optarg);
+			break;
+
+			case OPT_READYNODES:
+			nodeopts.readynodes = std::strtoul(optarg, nullptr, 10);
+			break;
+
+			case OPT_READYWAIT:
+			nodeopts.readywait = std::strtod(optarg, nullptr);
+			break;
+
 			case 's':
 			if (optarg[1])
 			{
@@ -100,228 +372,114 @@ int main(int argc, char *argv[])
 		}
 	}
 
-	if (optind + 1 != argc)
+	if (optind == argc)
 	{
-		std::cerr << argv[0] << ": " << ((optind==argc) ? "No node_name specified!" : "Too many arguments!") << std::endl;
+		std::cerr << argv[0] << ": " << "No node_name specified!" << std::endl;
 		Usage(std::cerr, argv[0]);
 		exit(EXIT_FAILURE);
 	}
 
-	auto p = argv[optind];
-	while (*p)
+	std::list<std::string> names;
+	bool fromstdin = false;
+	for (int i=optind; i<argc; i++)
 	{
-		if (std::islower(*p))
-			*p = std::toupper(*p);
-		p++;
+		if (0 == strcmp(argv[i], "-"))
+			fromstdin = true;
+		else
+			names.emplace_back(argv[i]);
 	}
-	const std::string key(argv[optind]);
-	auto keyhash = dht::InfoHash::get(key);
-
-	mrefdConfig.timestamp = mrefdPeers.timestamp = 0;
-	urfdConfig.timestamp  = urfdPeers.timestamp  = 0;
+	const bool batch = fromstdin || names.size() > 1;
 
-	ENodeType keytype;
-	if (0 == key.compare(0, 4, "M17-"))
-		keytype = ENodeType::mrefd;
-	else if (0 == key.compare(0, 3, "URF"))
-		keytype = ENodeType::urfd;
-	else
-	{
-		std::cerr << "Don't know how to get '" << key << "'" << std::endl;
+	// a single node_name is checked before connecting, just like it always was
+	if (! batch && nullptr == NewReflector(names.front()))
 		return EXIT_FAILURE;
-	}
 
-	switch (keytype)
-	{
-		case ENodeType::mrefd:
-			switch (section)
-			{
-				case 'c':
-				w.id(toUType(EMrefdValueID::Config));
-				break;
-
-				case 'p':
-				w.id(toUType(EMrefdValueID::Peers));
-				break;
-			}
-			break;
-		case ENodeType::urfd:
-			switch (section)
-			{
-				case 'c':
-				w.id(toUType(EUrfdValueID::Config));
-				break;
-
-				case 'p':
-				w.id(toUType(EUrfdValueID::Peers));
-				break;
-			}
-			break;
-	}
-
-	std::string name("HamGet");
-	name += std::to_string(getpid());
+	CRetrier retrier(tries);
+	CVerifier verifier;	// declared first, so it outlives the node's callbacks
 	dht::DhtRunner node;
 	try {
-		node.run(17171, dht::crypto::generateIdentity(name), true, 59973);
-		node.bootstrap(bs, "17171");
+		RunNode(node, "HamGet", bs, nodeopts);
+		verifier.Load(nodeopts.statedir);
 	} catch (const std::exception &ex) {
 		std::cout << argv[0] << " can't connect to the Ham-DHT! " << ex.what() << std::endl;
 		return 1;
 	}
-	switch (keytype)
-	{
-		case ENodeType::mrefd:
-			node.get(
-				keyhash,
-				[](const std::shared_ptr<dht::Value> &v) {
-					if (v->checkSignature())
-					{
-						switch (v->id)
-						{
-							case toUType(EMrefdValueID::Config):
-								if (0 == v->user_type.compare(MREFD_CONFIG_1))
-								{
-									auto rdat = dht::Value::unpack<SMrefdConfig1>(*v);
-									if (rdat.timestamp > mrefdConfig.timestamp)
-										mrefdConfig = dht::Value::unpack<SMrefdConfig1>(*v);
-								}
-								break;
-							case toUType(EMrefdValueID::Peers):
-								if (0 == v->user_type.compare(MREFD_PEERS_1))
-								{
-									auto rdat = dht::Value::unpack<SMrefdPeers1>(*v);
-									if (rdat.timestamp > mrefdPeers.timestamp)
-									{
-										mrefdPeers = dht::Value::unpack<SMrefdPeers1>(*v);
-									} else if (rdat.timestamp==mrefdPeers.timestamp)
-									{
-										if (rdat.sequence > mrefdPeers.sequence)
-											mrefdPeers = dht::Value::unpack<SMrefdPeers1>(*v);
-									}
-								}
-								break;
-						}
-					}
-					else
-					{
-						std::cout << "Value signature failed!" << std::endl;
-					}
-					return true;
-				},
-				[](bool success) {
-					if (! success)
-					{
-						std::cerr << "get() failed!" << std::endl;
-					}
-					std::unique_lock<std::mutex> lck(mtx);
-					running = false;
-					cv.notify_all();
-				},
-				{},	// empty filter
-				w
-			);
-			break;
-		case ENodeType::urfd:
-			node.get(
-				keyhash,
-				[](const std::shared_ptr<dht::Value> &v) {
-					if (v->checkSignature())
-					{
-						switch (v->id)
-						{
-							case toUType(EUrfdValueID::Config):
-								if (0 == v->user_type.compare(URFD_CONFIG_1))
-								{
-									auto rdat = dht::Value::unpack<SUrfdConfig1>(*v);
-									if (rdat.timestamp > urfdConfig.timestamp)
-										urfdConfig = dht::Value::unpack<SUrfdConfig1>(*v);
-								}
-								break;
-							case toUType(EUrfdValueID::Peers):
-								if (0 == v->user_type.compare(URFD_PEERS_1))
-								{
-									auto rdat = dht::Value::unpack<SUrfdPeers1>(*v);
-									if (rdat.timestamp > urfdPeers.timestamp)
-									{
-										urfdPeers = dht::Value::unpack<SUrfdPeers1>(*v);
-									} else if (rdat.timestamp==urfdPeers.timestamp)
-									{
-										if (rdat.sequence > urfdPeers.sequence)
-											urfdPeers = dht::Value::unpack<SUrfdPeers1>(*v);
-									}
-								}
-								break;
-						}
-					}
-					else
-					{
-						std::cout << "Value signature failed!" << std::endl;
-					}
-					return true;
-				},
-				[](bool success) {
-					if (! success)
-					{
-						std::cerr << "get() failed!" << std::endl;
-					}
-					std::unique_lock<std::mutex> lck(mtx);
-					running = false;
-					cv.notify_all();
-				},
-				{},	// empty filter
-				w
-			);
-			break;
-	}
+	stats.Phase("identity", nodeopts.idmsecs);
+	stats.Phase("bootstrap", nodeopts.readymsecs);
+
+	// lookups are issued from their own thread so this thread can output each one as it finishes
+	CLookupWindow window(inflight, std::chrono::milliseconds(long(1000.0 * timeout)));
+	std::thread issuer([&]() {
+		const auto lookups = stats.Start();
+		auto issue = [&](const std::string &name) {
+			auto refl = NewReflector(name);
+			if (refl)
+			{
+				{
+					std::lock_guard<std::mutex> lck(mtx);
+					started++;
+				}
+				Lookup(node, verifier, window, retrier, refl);
+			}
+		};
+		for (const auto &name : names)
+			issue(name);
+		if (fromstdin)
+		{
+			std::string name;
+			while (std::cin >> name)
+				issue(name);
+		}
+		// deadlines are only checked while the window is waiting
+		window.WaitAll();
+		stats.Phase("lookups", lookups);
+		std::lock_guard<std::mutex> lck(mtx);
+		reading = false;
+		cv.notify_all();
+	});
 
+	// everything that's finished is formatted into one buffer and written with a single flush
+	CJsonWriter json;
+	unsigned written = 0;
 	std::unique_lock<std::mutex> lck(mtx);
-	while (running)
+	while (reading || written < started)
 	{
-		cv.wait(lck);
-	}
+		if (finished.empty())
+		{
+			cv.wait(lck);
+			continue;
+		}
+		auto ready = std::move(finished);
+		finished.clear();
+		lck.unlock();
 
-	std::cout << '{';
-	switch (section)
-	{
-		case 'c':
-			switch (keytype)
-			{
-				case ENodeType::mrefd: PrintMrefdConfig(mrefdConfig, std::cout); break;
-				case ENodeType::urfd:  PrintUrfdConfig(urfdConfig, std::cout);  break;
-			}
-			break;
-		case 'p':
-			switch (keytype)
-			{
-				case ENodeType::mrefd: PrintMrefdPeers(mrefdPeers, use_local, std::cout); break;
-				case ENodeType::urfd:  PrintUrfdPeers(urfdPeers, use_local, std::cout);  break;
-			}
-			break;
-		default:
-			switch (keytype)
-			{
-				case ENodeType::mrefd:
-					if (mrefdConfig.timestamp)
-					{
-						PrintMrefdConfig(mrefdConfig, std::cout);
-						std::cout << ',';
-						PrintMrefdPeers(mrefdPeers, use_local, std::cout);
-					}
-					break;
-				case ENodeType::urfd:
-					if (urfdConfig.timestamp)
-					{
-						PrintUrfdConfig(urfdConfig, std::cout);
-						std::cout << ',';
-						PrintUrfdPeers(urfdPeers, use_local, std::cout);
-					}
-					break;
-			}
+		const auto output = stats.Start();
+		for (const auto &refl : ready)
+			Print(*refl, batch, json);
+		json.Write(std::cout);
+		stats.Phase("output", output);
+
+		lck.lock();
+		written += ready.size();
 	}
-	std::cout << '}' << std::endl;
+	lck.unlock();
+	issuer.join();
+	retrier.Stop();
+	if (retrier.Retries())
+		std::cerr << retrier.Retries() << " lookup(s) were retried" << std::endl;
 
+	verifier.Save();
+	SaveNodes(node, nodeopts);
 	node.join();
 
+	stats.Count("good_nodes", nodeopts.goodnodes);
+	stats.Count("signatures_cached", verifier.Hits());
+	stats.Count("signatures_verified", verifier.Misses());
+	stats.Count("signatures_failed", verifier.Failures());
+	stats.Count("retries", retrier.Retries());
+	stats.Count("abandoned", window.Abandoned());
+	stats.Phase("total", start);
+	stats.Write(std::cerr);
+
 	return EXIT_SUCCESS;
 }
@@ -0,0 +1,167 @@
+/*
+ *   Copyright (c) 2026 by Thomas A. Early N7TAE
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <algorithm>
+
+#include "dht-graph.h"
+
+static uint32_t ModuleMask(const std::string &modules)
+{
+	uint32_t mask = 0;
+	for (const auto c : modules)
+		mask |= CPeerGraph::Bit(std::toupper(c));
+	return mask;
+}
+
+CPeerGraph::CPeerGraph(const PeerLinks &links)
+{
+	// intern every callsign, both the crawled reflectors and the peers they list
+	for (const auto &item : links)
+	{
+		names.push_back(item.first);
+		for (const auto &l : item.second.links)
+			names.push_back(l.callsign);
+	}
+	std::sort(names.begin(), names.end());
+	names.erase(std::unique(names.begin(), names.end()), names.end());
+	index.reserve(names.size());
+	for (uint32_t i=0; i<names.size(); i++)
+		index.emplace(names[i], i);
+
+	received.assign(names.size(), false);
+	offsets.assign(names.size() + 1, 0);
+
+	// links is ordered by callsign, just like the ids, so the rows are built in order
+	std::vector<std::pair<uint32_t, uint32_t>> row; // (target, index into the peer list)
+	auto it = links.begin();
+	for (uint32_t id=0; id<names.size(); id++)
+	{
+		offsets[id] = uint32_t(targets.size());
+		if (links.end() == it || it->first != names[id])
+			continue;
+		const auto &list = it++->second;
+		received[id] = list.received;
+
+		row.clear();
+		for (uint32_t i=0; i<list.links.size(); i++)
+			row.emplace_back(index.at(list.links[i].callsign), i);
+		std::sort(row.begin(), row.end());
+		for (const auto &r : row)
+		{
+			const auto &l = list.links[r.second];
+			const auto mask = ModuleMask(l.modules);
+			allmodules |= mask;
+			// a peer that's listed more than once is one link with all of its modules
+			if (targets.size() > offsets[id] && targets.back() == r.first)
+			{
+				masks.back() |= mask;
+				continue;
+			}
+			targets.push_back(r.first);
+			masks.push_back(mask);
+			connects.push_back(l.connect);
+		}
+	}
+	offsets[names.size()] = uint32_t(targets.size());
+}
+
+uint32_t CPeerGraph::Find(const std::string &callsign) const
+{
+	auto it = index.find(callsign);
+	return (index.end() == it) ? none : it->second;
+}
+
+uint32_t CPeerGraph::Degree(uint32_t id, char module) const
+{
+	const auto bit = Bit(module);
+	uint32_t n = 0;
+	for (auto l=Begin(id); l<End(id); l++)
+	{
+		if (masks[l] & bit)
+			n++;
+	}
+	return n;
+}
+
+bool CPeerGraph::HasLink(uint32_t from, uint32_t to, char module) const
+{
+	const auto first = targets.begin() + Begin(from);
+	const auto last  = targets.begin() + End(from);
+	const auto it = std::lower_bound(first, last, to);
+	return it != last && *it == to && (masks[it - targets.begin()] & Bit(module));
+}
+
+std::vector<uint32_t> CPeerGraph::Components(char module) const
+{
+	const auto bit = Bit(module);
+	std::vector<uint32_t> parent(names.size(), none);
+	auto root = [&parent](uint32_t i)
+	{
+		while (parent[i] != i)
+		{
+			parent[i] = parent[parent[i]];
+			i = parent[i];
+		}
+		return i;
+	};
+
+	for (uint32_t id=0; id<names.size(); id++)
+	{
+		for (auto l=Begin(id); l<End(id); l++)
+		{
+			if (0 == (masks[l] & bit))
+				continue;
+			const auto to = targets[l];
+			if (none == parent[id])
+				parent[id] = id;
+			if (none == parent[to])
+				parent[to] = to;
+			// the smaller root always wins, so each group ends up named by its smallest id
+			const auto a = root(id);
+			const auto b = root(to);
+			if (a < b)
+				parent[b] = a;
+			else if (b < a)
+				parent[a] = b;
+		}
+	}
+
+	for (uint32_t id=0; id<names.size(); id++)
+	{
+		if (none != parent[id])
+			parent[id] = root(id);
+	}
+	return parent;
+}
+
+std::vector<std::pair<uint32_t, uint32_t>> CPeerGraph::Asymmetric(char module) const
+{
+	const auto bit = Bit(module);
+	std::vector<std::pair<uint32_t, uint32_t>> rval;
+	for (uint32_t id=0; id<names.size(); id++)
+	{
+		for (auto l=Begin(id); l<End(id); l++)
+		{
+			const auto to = targets[l];
+			// a peer that never answered can't be asked
+			if ((masks[l] & bit) && received[to] && ! HasLink(to, id, module))
+				rval.emplace_back(id, to);
+		}
+	}
+	return rval;
+}
@@ -0,0 +1,76 @@
+/*
+ *   Copyright (c) 2026 by Thomas A. Early N7TAE
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <utility>
+#include <unordered_map>
+
+#include "dht-crawl.h"
+
+// The peer links of a crawl in a compact form.
+// Every callsign is interned to a dense id, in alphabetical order, so id order is callsign order.
+// The links of reflector i are the entries [Begin(i), End(i)) of the link arrays, sorted by
+// target, and each link has a bitset of the modules it shares: bit 0 is module A.
+class CPeerGraph
+{
+public:
+	static constexpr uint32_t none = UINT32_MAX;
+	static uint32_t Bit(char module) { return (module >= 'A' && module <= 'Z') ? 1u << (module - 'A') : 0u; }
+
+	CPeerGraph() = default;
+	explicit CPeerGraph(const PeerLinks &links);
+
+	uint32_t Size() const { return uint32_t(names.size()); }
+	const std::string &Name(uint32_t id) const { return names[id]; }
+	// the id of a callsign, or none
+	uint32_t Find(const std::string &callsign) const;
+	// false if this reflector's Peers were never received, so its links are unknown
+	bool Received(uint32_t id) const { return received[id]; }
+
+	uint32_t Begin(uint32_t id) const { return offsets[id]; }
+	uint32_t End(uint32_t id) const { return offsets[id+1]; }
+	uint32_t Target(uint32_t link) const { return targets[link]; }
+	uint32_t Modules(uint32_t link) const { return masks[link]; }
+	std::time_t Connect(uint32_t link) const { return connects[link]; }
+
+	// every module that is shared by at least one link
+	uint32_t AllModules() const { return allmodules; }
+	// the number of links of a reflector that share the module
+	uint32_t Degree(uint32_t id, char module) const;
+	// true if 'from' lists 'to' as a peer on the module
+	bool HasLink(uint32_t from, uint32_t to, char module) const;
+
+	// the connected group of each reflector on the module, ignoring the direction of the links
+	// a group is identified by its smallest id, a reflector without a link on the module is in group none
+	std::vector<uint32_t> Components(char module) const;
+	// the links (from, to) on the module where 'to' answered but doesn't list 'from'
+	std::vector<std::pair<uint32_t, uint32_t>> Asymmetric(char module) const;
+
+protected:
+	std::vector<std::string> names;
+	std::unordered_map<std::string, uint32_t> index;
+	std::vector<bool> received;
+	std::vector<uint32_t> offsets; // Size()+1 of them
+	std::vector<uint32_t> targets, masks;
+	std::vector<std::time_t> connects;
+	uint32_t allmodules = 0;
+};
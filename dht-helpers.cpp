@@ -16,147 +16,140 @@
  *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
  */
 
-#include "dht-values.h"
-
-static const char *TimeString(const std::time_t tt, bool use_local)
-{
-	static char str[32];
-	if (use_local)
-		strftime(str, 32, "%F %T %Z", localtime(&tt));
-	else
-		strftime(str, 32, "%FT%TZ", gmtime(&tt));
-	return str;
-}
+#include "dht-helpers.h"
 
 #ifdef USE_MREFD_VALUES
-void PrintMrefdConfig(const SMrefdConfig1 &mrefdConfig, std::ostream &stream)
+void PrintMrefdConfig(const SMrefdConfig1 &mrefdConfig, CJsonWriter &json)
 {
-	stream << "\"Configuration\":{";
+	json.BeginObject("Configuration");
 	if (mrefdConfig.timestamp)
 	{
-		stream
-			<< "\"Callsign\":\""    << mrefdConfig.callsign      << "\","
-			<< "\"Version\":\""     << mrefdConfig.version       << "\","
-			<< "\"Modules\":\""     << mrefdConfig.modules       << "\","
-			<< "\"EncryptMods\":\"" << mrefdConfig.encryptedmods << "\","
-			<< "\"IPv4Address\":\"" << mrefdConfig.ipv4addr      << "\","
-			<< "\"IPv6Address\":\"" << mrefdConfig.ipv6addr      << "\","
-			<< "\"URL\":\""         << mrefdConfig.url           << "\","
-			<< "\"Country\":\""     << mrefdConfig.country       << "\","
-			<< "\"Sponsor\":\""     << mrefdConfig.sponsor       << "\","
-			<< "\"Email\":\""       << mrefdConfig.email         << "\","
-			<< "\"Port\":"          << mrefdConfig.port;
+		json
+			.Str("Callsign",    mrefdConfig.callsign)
+			.Str("Version",     mrefdConfig.version)
+			.Str("Modules",     mrefdConfig.modules)
+			.Str("EncryptMods", mrefdConfig.encryptedmods)
+			.Str("IPv4Address", mrefdConfig.ipv4addr)
+			.Str("IPv6Address", mrefdConfig.ipv6addr)
+			.Str("URL",         mrefdConfig.url)
+			.Str("Country",     mrefdConfig.country)
+			.Str("Sponsor",     mrefdConfig.sponsor)
+			.Str("Email",       mrefdConfig.email)
+			.Int("Port",        mrefdConfig.port);
 	}
-	stream << '}';
+	json.EndObject();
 }
 
-void PrintMrefdPeers(const SMrefdPeers1 &mrefdPeers, bool use_local, std::ostream &stream)
+void PrintMrefdPeers(const SMrefdPeers1 &mrefdPeers, bool use_local, CJsonWriter &json)
 {
-	stream << "\"Peers\":[";
-	auto pit=mrefdPeers.list.cbegin();
-	while (pit != mrefdPeers.list.cend())
+	json.BeginArray("Peers");
+	for (const auto &p : mrefdPeers.list)
 	{
-		stream <<
-			"{\"Callsign\":\""   << std::get<toUType(EMrefdPeerFields::Callsign)>(*pit) << "\"," <<
-			"\"Modules\":\""     << std::get<toUType(EMrefdPeerFields::Modules)>(*pit)  << "\"," <<
-			"\"ConnectTime\":\"" << TimeString(std::get<toUType(EMrefdPeerFields::ConnectTime)>(*pit), use_local) << "\"}";
-		if (++pit != mrefdPeers.list.end())
-			stream << ',';
+		json.BeginObject()
+			.Str("Callsign",     std::get<toUType(EMrefdPeerFields::Callsign)>(p))
+			.Str("Modules",      std::get<toUType(EMrefdPeerFields::Modules)>(p))
+			.Time("ConnectTime", std::get<toUType(EMrefdPeerFields::ConnectTime)>(p), use_local)
+			.EndObject();
 	}
-	stream << ']';
+	json.EndArray();
 }
 
-void PrintMrefdClients(const SMrefdClients1 &mrefdClients, bool use_local, std::ostream &stream)
+void PrintMrefdClient(const MrefdClientTuple &client, bool use_local, CJsonWriter &json)
 {
-	stream << "\"Clients\":[";
-	auto cit = mrefdClients.list.cbegin();
-	while (cit != mrefdClients.list.cend())
-	{
-		stream <<
-			"{\"Module\":\""       << std::get<toUType(EMrefdClientFields::Module)>(*cit)                    << "\"," <<
-			"\"Callsign\":\""      << std::get<toUType(EMrefdClientFields::Callsign)>(*cit)                  << "\"," <<
-			"\"IP\":\""            << std::get<toUType(EMrefdClientFields::Ip)>(*cit)                        << "\"," <<
-			"\"ConnectTime\":\""   << TimeString(std::get<toUType(EMrefdClientFields::ConnectTime)>(*cit), use_local)   << "\"," <<
-			"\"LastHeardTime\":\"" << TimeString(std::get<toUType(EMrefdClientFields::LastHeardTime)>(*cit), use_local) << "\"}";
-		if (++cit != mrefdClients.list.cend())
-			stream << ',';
-	}
-	stream << ']';
+	json.BeginObject()
+		.Chr("Module",         std::get<toUType(EMrefdClientFields::Module)>(client))
+		.Str("Callsign",       std::get<toUType(EMrefdClientFields::Callsign)>(client))
+		.Str("IP",             std::get<toUType(EMrefdClientFields::Ip)>(client))
+		.Time("ConnectTime",   std::get<toUType(EMrefdClientFields::ConnectTime)>(client), use_local)
+		.Time("LastHeardTime", std::get<toUType(EMrefdClientFields::LastHeardTime)>(client), use_local)
+		.EndObject();
 }
 
-void PrintMrefdUsers(const SMrefdUsers1 &mrefdUsers, bool use_local, std::ostream &stream)
+void PrintMrefdClients(const SMrefdClients1 &mrefdClients, bool use_local, CJsonWriter &json)
 {
-	stream << "\"Users\":[";
-	auto uit = mrefdUsers.list.cbegin();
-	while (uit != mrefdUsers.list.cend())
-	{
-		stream <<
-			"{\"Source\":\""       << std::get<toUType(EMrefdUserFields::Source)>(*uit)                    << "\"," <<
-			"\"Destination\":\""   << std::get<toUType(EMrefdUserFields::Destination)>(*uit)               << "\"," <<
-			"\"Reflector\":\""     << std::get<toUType(EMrefdUserFields::Reflector)>(*uit)                 << "\"," <<
-			"\"LastHeardTime\":\"" << TimeString(std::get<toUType(EMrefdUserFields::LastHeardTime)>(*uit), use_local) << "\"}";
-		if (++uit != mrefdUsers.list.cend())
-			stream << ',';
-	}
-	stream << ']';
+	json.BeginArray("Clients");
+	for (const auto &c : mrefdClients.list)
+		PrintMrefdClient(c, use_local, json);
+	json.EndArray();
+}
+
+void PrintMrefdUser(const MrefdUserTuple &user, bool use_local, CJsonWriter &json)
+{
+	json.BeginObject()
+		.Str("Source",         std::get<toUType(EMrefdUserFields::Source)>(user))
+		.Str("Destination",    std::get<toUType(EMrefdUserFields::Destination)>(user))
+		.Str("Reflector",      std::get<toUType(EMrefdUserFields::Reflector)>(user))
+		.Time("LastHeardTime", std::get<toUType(EMrefdUserFields::LastHeardTime)>(user), use_local)
+		.EndObject();
+}
+
+void PrintMrefdUsers(const SMrefdUsers1 &mrefdUsers, bool use_local, CJsonWriter &json)
+{
+	json.BeginArray("Users");
+	for (const auto &u : mrefdUsers.list)
+		PrintMrefdUser(u, use_local, json);
+	json.EndArray();
 }
 #endif
 
-void PrintUrfdConfig(const SUrfdConfig1 urfdConfig, std::ostream &stream)
+#ifdef USE_URFD_VALUES
+void PrintUrfdConfig(const SUrfdConfig1 &urfdConfig, CJsonWriter &json)
 {
-	stream << "\"Configuration\":{";
+	json.BeginObject("Configuration");
 	if (urfdConfig.timestamp)
 	{
-		stream
-			<< "\"Callsign\":\""           << urfdConfig.callsign        << "\","
-			<< "\"Version\":\""            << urfdConfig.version         << "\","
-			<< "\"Modules\":\""            << urfdConfig.modules         << "\","
-			<< "\"TranscodedModules\":\""  << urfdConfig.transcodedmods  << "\",";
-			for (const auto c : urfdConfig.modules)
-			{
-				stream << "\"Description" << c << "\":\"" << urfdConfig.description.at(c) << "\",";
-			}
-		stream
-			<< "\"IPv4Address\":\""        << urfdConfig.ipv4addr                            << "\","
-			<< "\"IPv6Address\":\""        << urfdConfig.ipv6addr                            << "\","
-			<< "\"URL\":\""                << urfdConfig.url                                 << "\","
-			<< "\"Country\":\""            << urfdConfig.country                             << "\","
-			<< "\"Sponsor\":\""            << urfdConfig.sponsor                             << "\","
-			<< "\"Email\":\""              << urfdConfig.email                               << "\","
-			<< "\"DCSPort\":"              << urfdConfig.port[toUType(EUrfdPorts::dcs)]     << ","
-			<< "\"DExtraPort\":"           << urfdConfig.port[toUType(EUrfdPorts::dextra)]  << ","
-			<< "\"DMRPlusPort\":"          << urfdConfig.port[toUType(EUrfdPorts::dmrplus)] << ","
-			<< "\"DPlusPort\":"            << urfdConfig.port[toUType(EUrfdPorts::dplus)]   << ","
-			<< "\"M17Port\":"              << urfdConfig.port[toUType(EUrfdPorts::m17)]     << ","
-			<< "\"MMDVMPort\":"            << urfdConfig.port[toUType(EUrfdPorts::mmdvm)]   << ","
-			<< "\"NXDNPort\":"             << urfdConfig.port[toUType(EUrfdPorts::nxdn)]    << ","
-			<< "\"NXDNAutoLinkModule\":\"" << urfdConfig.almod[toUType(EUrfdAlMod::nxdn)]    << "\","
-			<< "\"NXDNReflectorID\":"      << urfdConfig.refid[toUType(EUrfdRefId::nxdn)]    << ","
-			<< "\"P25Port\":"              << urfdConfig.port[toUType(EUrfdPorts::p25)]     << ","
-			<< "\"P25AutoLinkModule\":\""  << urfdConfig.almod[toUType(EUrfdAlMod::p25)]     << "\","
-			<< "\"P25ReflectorID\":"       << urfdConfig.refid[toUType(EUrfdRefId::p25)]     << ","
-			<< "\"URFPort\":"              << urfdConfig.port[toUType(EUrfdPorts::urf)]     << ","
-			<< "\"YSFPort\":"              << urfdConfig.port[toUType(EUrfdPorts::ysf)]     << ","
-			<< "\"YSFPort\":"              << urfdConfig.port[toUType(EUrfdPorts::ysf)]     << ","
-			<< "\"YSFAutoLinkModule\":\""  << urfdConfig.almod[toUType(EUrfdAlMod::ysf)]     << "\","
-			<< "\"YSFDefaultRxFreq\":"     << urfdConfig.ysffreq[toUType(EUrfdTxRx::rx)]     << ","
-			<< "\"YSFDefaultTxFreq\":"     << urfdConfig.ysffreq[toUType(EUrfdTxRx::tx)];
+		json
+			.Str("Callsign",          urfdConfig.callsign)
+			.Str("Version",           urfdConfig.version)
+			.Str("Modules",           urfdConfig.modules)
+			.Str("TranscodedModules", urfdConfig.transcodedmods);
+		char key[] = "DescriptionX";
+		for (const auto c : urfdConfig.modules)
+		{
+			// a module without a description has an empty one
+			key[sizeof(key)-2] = c;
+			auto it = urfdConfig.description.find(c);
+			json.Str(key, (urfdConfig.description.end() == it) ? std::string_view() : std::string_view(it->second));
+		}
+		json
+			.Str("IPv4Address",        urfdConfig.ipv4addr)
+			.Str("IPv6Address",        urfdConfig.ipv6addr)
+			.Str("URL",                urfdConfig.url)
+			.Str("Country",            urfdConfig.country)
+			.Str("Sponsor",            urfdConfig.sponsor)
+			.Str("Email",              urfdConfig.email)
+			.Int("DCSPort",            urfdConfig.port[toUType(EUrfdPorts::dcs)])
+			.Int("DExtraPort",         urfdConfig.port[toUType(EUrfdPorts::dextra)])
+			.Int("DMRPlusPort",        urfdConfig.port[toUType(EUrfdPorts::dmrplus)])
+			.Int("DPlusPort",          urfdConfig.port[toUType(EUrfdPorts::dplus)])
+			.Int("M17Port",            urfdConfig.port[toUType(EUrfdPorts::m17)])
+			.Int("MMDVMPort",          urfdConfig.port[toUType(EUrfdPorts::mmdvm)])
+			.Int("NXDNPort",           urfdConfig.port[toUType(EUrfdPorts::nxdn)])
+			.Chr("NXDNAutoLinkModule", urfdConfig.almod[toUType(EUrfdAlMod::nxdn)])
+			.Int("NXDNReflectorID",    urfdConfig.refid[toUType(EUrfdRefId::nxdn)])
+			.Int("P25Port",            urfdConfig.port[toUType(EUrfdPorts::p25)])
+			.Chr("P25AutoLinkModule",  urfdConfig.almod[toUType(EUrfdAlMod::p25)])
+			.Int("P25ReflectorID",     urfdConfig.refid[toUType(EUrfdRefId::p25)])
+			.Int("URFPort",            urfdConfig.port[toUType(EUrfdPorts::urf)])
+			.Int("YSFPort",            urfdConfig.port[toUType(EUrfdPorts::ysf)])
+			.Chr("YSFAutoLinkModule",  urfdConfig.almod[toUType(EUrfdAlMod::ysf)])
+			.Int("YSFDefaultRxFreq",   urfdConfig.ysffreq[toUType(EUrfdTxRx::rx)])
+			.Int("YSFDefaultTxFreq",   urfdConfig.ysffreq[toUType(EUrfdTxRx::tx)]);
 	}
-	stream << '}';
+	json.EndObject();
 }
 
-void PrintUrfdPeers(const SUrfdPeers1 &urfdPeers, bool use_local, std::ostream &stream)
+void PrintUrfdPeers(const SUrfdPeers1 &urfdPeers, bool use_local, CJsonWriter &json)
 {
-	stream << "\"Peers\":[";
-	auto pit=urfdPeers.list.cbegin();
-	while (pit != urfdPeers.list.cend())
+	json.BeginArray("Peers");
+	for (const auto &p : urfdPeers.list)
 	{
-		stream <<
-			"{\"Callsign\":\""   << std::get<toUType(EUrfdPeerFields::Callsign)>(*pit) << "\"," <<
-			"\"Modules\":\""     << std::get<toUType(EUrfdPeerFields::Modules)>(*pit)  << "\"," <<
-			"\"ConnectTime\":\"" << TimeString(std::get<toUType(EUrfdPeerFields::ConnectTime)>(*pit), use_local) << "\"}";
-		if (++pit != urfdPeers.list.end())
-			stream << ',';
+		json.BeginObject()
+			.Str("Callsign",     std::get<toUType(EUrfdPeerFields::Callsign)>(p))
+			.Str("Modules",      std::get<toUType(EUrfdPeerFields::Modules)>(p))
+			.Time("ConnectTime", std::get<toUType(EUrfdPeerFields::ConnectTime)>(p), use_local)
+			.EndObject();
 	}
-	stream << ']';
+	json.EndArray();
 }
+#endif
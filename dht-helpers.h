@@ -18,18 +18,22 @@
 
 #pragma once
 
-#include <iostream>
-
 #include "dht-values.h"
+#include "dht-json.h"
+
+// each of these writes a single json value, keyed by its section name except for the list items
 
 #ifdef USE_MREFD_VALUES
-extern void PrintMrefdConfig(const SMrefdConfig1 &mrefdConfig, std::ostream &stream);
-extern void PrintMrefdPeers(const SMrefdPeers1 &mrefdPeers, bool use_local, std::ostream &stream);
-extern void PrintMrefdClients(const SMrefdClients1 &mrefdClients, bool use_local, std::ostream &stream);
-extern void PrintMrefdUsers(const SMrefdUsers1 &mrefdUsers, bool use_local, std::ostream &stream);
+extern void PrintMrefdConfig(const SMrefdConfig1 &mrefdConfig, CJsonWriter &json);
+extern void PrintMrefdPeers(const SMrefdPeers1 &mrefdPeers, bool use_local, CJsonWriter &json);
+extern void PrintMrefdClients(const SMrefdClients1 &mrefdClients, bool use_local, CJsonWriter &json);
+extern void PrintMrefdUsers(const SMrefdUsers1 &mrefdUsers, bool use_local, CJsonWriter &json);
+// a single item of the Clients or Users list
+extern void PrintMrefdClient(const MrefdClientTuple &client, bool use_local, CJsonWriter &json);
+extern void PrintMrefdUser(const MrefdUserTuple &user, bool use_local, CJsonWriter &json);
 #endif
 
 #ifdef USE_URFD_VALUES
-extern void PrintUrfdConfig(const SUrfdConfig1 urfdConfig, std::ostream &stream);
-extern void PrintUrfdPeers(const SUrfdPeers1 &urfdPeers, bool use_local, std::ostream &stream);
+extern void PrintUrfdConfig(const SUrfdConfig1 &urfdConfig, CJsonWriter &json);
+extern void PrintUrfdPeers(const SUrfdPeers1 &urfdPeers, bool use_local, CJsonWriter &json);
 #endif
@@ -0,0 +1,84 @@
+/*
+ *   Copyright (c) 2026 by Thomas A. Early N7TAE
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <unistd.h>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+#include "dht-file.h"
+#include "dht-hostcache.h"
+
+void CHostCache::Load(const std::string &statedir)
+{
+	if (statedir.empty())
+		return;
+	path.assign(statedir + "/hostcache");
+
+	// the cache is a msgpack'ed std::vector<SHostCacheEntry>
+	std::ifstream ifile(path, std::ios::binary);
+	if (! ifile.is_open())
+		return;
+	const std::string buf((std::istreambuf_iterator<char>(ifile)), std::istreambuf_iterator<char>());
+	ifile.close();
+	try {
+		auto oh = msgpack::unpack(buf.data(), buf.size());
+		auto list = oh.get().as<std::vector<SHostCacheEntry>>();
+		std::lock_guard<std::mutex> lck(mtx);
+		for (auto &e : list)
+		{
+			auto key = e.designator;
+			entries[key] = std::move(e);
+		}
+	} catch (const std::exception &ex) {
+		std::cerr << "WARNING: ignoring the host cache: " << ex.what() << std::endl;
+	}
+}
+
+void CHostCache::Save()
+{
+	if (path.empty())
+		return;
+	std::vector<SHostCacheEntry> list;
+	{
+		std::lock_guard<std::mutex> lck(mtx);
+		list.reserve(entries.size());
+		for (const auto &item : entries)
+			list.push_back(item.second);
+	}
+
+	msgpack::sbuffer buf;
+	msgpack::pack(buf, list);
+	AtomicWrite(path, 0644, { { buf.data(), buf.size() } });
+}
+
+bool CHostCache::Find(const std::string &designator, SHostCacheEntry &entry)
+{
+	std::lock_guard<std::mutex> lck(mtx);
+	auto it = entries.find(designator);
+	if (entries.end() == it)
+		return false;
+	entry = it->second;
+	return true;
+}
+
+void CHostCache::Store(const SHostCacheEntry &entry)
+{
+	std::lock_guard<std::mutex> lck(mtx);
+	entries[entry.designator] = entry;
+}
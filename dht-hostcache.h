@@ -0,0 +1,59 @@
+/*
+ *   Copyright (c) 2026 by Thomas A. Early N7TAE
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#pragma once
+
+#include <opendht.h>
+#include <cstdint>
+#include <ctime>
+#include <map>
+#include <mutex>
+#include <string>
+
+// the last Config accepted for one reflector, already decoded into host file fields
+struct SHostCacheEntry
+{
+	std::string designator, version, mods, smods, ipv4, ipv6, url;
+	uint16_t port = 0;
+	int64_t timestamp = 0; // the Config's own timestamp
+	uint16_t seq = 0;      // the seq of the dht::Value the Config came in
+	int64_t checked = 0;   // when a full get() last verified this Config, a seq check doesn't count
+
+	MSGPACK_DEFINE(designator, version, mods, smods, ipv4, ipv6, url, port, timestamp, seq, checked)
+};
+
+// The reflector Configs found by earlier runs, kept in <statedir>/hostcache.
+// Configs are permanent values that rarely change, so an entry that was verified recently
+// only needs a query() of its value's seq, not a full get() and a signature check.
+// Once the refresh time has passed since it was verified, it gets a full get() again.
+class CHostCache
+{
+public:
+	void Load(const std::string &statedir);
+	// replaces the file with AtomicWrite()
+	void Save();
+
+	// false if there's no entry for the designator
+	bool Find(const std::string &designator, SHostCacheEntry &entry);
+	void Store(const SHostCacheEntry &entry);
+
+private:
+	std::mutex mtx;
+	std::string path;
+	std::map<std::string, SHostCacheEntry> entries;
+};
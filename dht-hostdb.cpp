@@ -0,0 +1,105 @@
+/*
+ *   Copyright (c) 2026 by Thomas A. Early N7TAE
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <arpa/inet.h>
+#include <map>
+
+#include "dht-file.h"
+#include "dht-hostdb.h"
+
+bool CHostDb::Write(const std::string &path, const std::vector<SEntry> &entries)
+{
+	// the same string is only stored once, and every empty string is offset 0
+	std::string strings(1, '\0');
+	std::map<std::string, uint32_t> offsets { { std::string(), 0 } };
+	auto add = [&](const std::string &s) -> uint32_t
+	{
+		auto it = offsets.find(s);
+		if (offsets.end() != it)
+			return it->second;
+		const auto off = uint32_t(strings.size());
+		strings.append(s);
+		strings.push_back('\0');
+		offsets.emplace(s, off);
+		return off;
+	};
+	auto mask = [](const std::string &mods)
+	{
+		uint32_t m = 0;
+		for (auto c : mods)
+			m |= Bit(c);
+		return m;
+	};
+
+	// at most half full, so a miss is found quickly
+	uint32_t buckets = 8;
+	while (buckets < 2 * entries.size())
+		buckets *= 2;
+	std::vector<uint32_t> index(buckets, 0);
+	std::vector<SHostDbRecord> records;
+	records.reserve(entries.size());
+	for (const auto &e : entries)
+	{
+		// a designator that is already in the index would never be found, so keep the first one
+		auto b = Hash(e.cs) & (buckets - 1);
+		bool dup = false;
+		for ( ; index[b]; b = (b + 1) & (buckets - 1))
+		{
+			if (0 == strings.compare(records[index[b] - 1].name, e.cs.size() + 1, e.cs.c_str(), e.cs.size() + 1))
+			{
+				dup = true;
+				break;
+			}
+		}
+		if (dup)
+			continue;
+
+		SHostDbRecord rec;
+		memset(&rec, 0, sizeof(rec));
+		rec.name = add(e.cs);
+		rec.version = add(e.version);
+		rec.url = add(e.url);
+		rec.mods = mask(e.mods);
+		rec.smods = mask(e.smods);
+		if (1 == inet_pton(AF_INET, e.ipv4.c_str(), rec.ipv4))
+			rec.flags |= HDB_IPV4;
+		if (1 == inet_pton(AF_INET6, e.ipv6.c_str(), rec.ipv6))
+			rec.flags |= HDB_IPV6;
+		rec.port = e.port;
+		if (e.dht)
+			rec.flags |= HDB_DHT;
+		records.push_back(rec);
+		index[b] = uint32_t(records.size());
+	}
+
+	SHostDbHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, Magic(), 4);
+	header.version = FileVersion;
+	header.created = std::time(nullptr);
+	header.records = uint32_t(records.size());
+	header.buckets = buckets;
+	header.strbytes = uint32_t(strings.size());
+
+	return AtomicWrite(path, 0644, {
+		{ &header, sizeof(header) },
+		{ index.data(), 4 * index.size() },
+		{ records.data(), sizeof(SHostDbRecord) * records.size() },
+		{ strings.data(), strings.size() }
+	});
+}
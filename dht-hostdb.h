@@ -0,0 +1,223 @@
+/*
+ *   Copyright (c) 2026 by Thomas A. Early N7TAE
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#pragma once
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// host database file layout, all integers are in host byte order:
+//   SHostDbHeader
+//   uint32_t       hash index, 'buckets' of them, each one is a record number plus one, or 0 if empty
+//   SHostDbRecord  one for each reflector, in the same order as the host file
+//   the strings, each one terminated by a nul
+// the header and the records are multiples of 4 bytes, so every array is aligned in the mapped file
+struct SHostDbHeader
+{
+	char magic[4];
+	uint32_t version;
+	int64_t created;
+	uint32_t records, buckets, strbytes, reserved;
+};
+static_assert(32 == sizeof(SHostDbHeader), "the host database header must not have any padding");
+
+struct SHostDbRecord
+{
+	uint32_t name, version, url; // offsets into the strings, an unknown version is an empty string
+	uint32_t mods, smods;        // module bit sets, 'A' is bit 0
+	uint8_t ipv4[4];             // network byte order
+	uint8_t ipv6[16];            // network byte order
+	uint16_t port;
+	uint8_t flags;               // the HDB_ bits
+	uint8_t pad;
+};
+static_assert(44 == sizeof(SHostDbRecord), "a host database record must not have any padding");
+
+enum { HDB_IPV4 = 0x1, HDB_IPV6 = 0x2, HDB_DHT = 0x4 };
+
+// A host file saved as a hash table that is read with mmap(). A lookup hashes the designator
+// and compares it with the record in its bucket, or the next ones, so it needs no parsing and
+// no allocation. The reader is entirely in this header so any program can use it on its own.
+class CHostDb
+{
+public:
+	// one reflector, as it goes into the file
+	struct SEntry
+	{
+		std::string cs, version, mods, smods, ipv4, ipv6, url;
+		uint16_t port = 0;
+		bool dht = false; // the values came from the Ham-DHT
+	};
+
+	CHostDb() = default;
+	CHostDb(const CHostDb &) = delete;
+	CHostDb &operator=(const CHostDb &) = delete;
+	~CHostDb() { Close(); }
+
+	// replaces the file with AtomicWrite()
+	static bool Write(const std::string &path, const std::vector<SEntry> &entries);
+
+	// false, with the reason in 'error', if the file can't be read or isn't a host database
+	bool Open(const std::string &path, std::string &error)
+	{
+		Close();
+		error.clear();
+		auto fd = open(path.c_str(), O_RDONLY);
+		if (fd < 0)
+		{
+			error.assign(strerror(errno));
+			return false;
+		}
+		struct stat sb;
+		if (fstat(fd, &sb) || std::size_t(sb.st_size) < sizeof(SHostDbHeader))
+		{
+			close(fd);
+			error.assign("too short to be a host database");
+			return false;
+		}
+		size = sb.st_size;
+		map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		close(fd);
+		if (MAP_FAILED == map)
+		{
+			map = nullptr;
+			error.assign(strerror(errno));
+			return false;
+		}
+
+		const auto *data = static_cast<const uint8_t *>(map);
+		SHostDbHeader header;
+		memcpy(&header, data, sizeof(header));
+		if (memcmp(header.magic, Magic(), 4))
+			error.assign("not a host database");
+		else if (FileVersion != header.version)
+			error.assign("unsupported host database version " + std::to_string(header.version));
+		else if (header.buckets <= header.records || (header.buckets & (header.buckets - 1)))
+			error.assign("the host database index is corrupt");
+		else if (size != FileSize(header.records, header.buckets, header.strbytes))
+			error.assign("the host database has the wrong size");
+		if (! error.empty())
+		{
+			Close();
+			return false;
+		}
+
+		records = header.records;
+		buckets = header.buckets;
+		created = header.created;
+		index   = reinterpret_cast<const uint32_t *>(data + sizeof(SHostDbHeader));
+		record  = reinterpret_cast<const SHostDbRecord *>(index + buckets);
+		strings = reinterpret_cast<const char *>(record + records);
+		strbytes = header.strbytes;
+
+		// the lookups trust the index and the offsets, so check every one of them now
+		// every record must be in the index exactly once, so there are always empty buckets,
+		// which is what ends the probing in Find() for a designator that isn't there
+		bool ok = strbytes > 0 && 0 == strings[strbytes - 1];
+		std::vector<bool> indexed(records, false);
+		uint32_t used = 0;
+		for (uint32_t b=0; ok && b<buckets; b++)
+		{
+			if (0 == index[b])
+				continue;
+			ok = index[b] <= records && ! indexed[index[b] - 1];
+			if (ok)
+			{
+				indexed[index[b] - 1] = true;
+				used++;
+			}
+		}
+		ok = ok && records == used;
+		for (uint32_t r=0; ok && r<records; r++)
+			ok = record[r].name < strbytes && record[r].version < strbytes && record[r].url < strbytes;
+		if (! ok)
+		{
+			error.assign("the host database is corrupt");
+			Close();
+		}
+		return ok;
+	}
+
+	void Close()
+	{
+		if (map)
+			munmap(map, size);
+		map = nullptr;
+		size = 0;
+		records = buckets = strbytes = 0;
+	}
+
+	std::time_t Created() const { return created; }
+	uint32_t Size() const { return records; }
+	const SHostDbRecord &Record(uint32_t r) const { return record[r]; }
+	std::string_view Str(uint32_t offset) const { return std::string_view(strings + offset); }
+
+	// nullptr if the designator isn't in the file
+	const SHostDbRecord *Find(std::string_view cs) const
+	{
+		if (0 == buckets)
+			return nullptr;
+		for (auto b = Hash(cs) & (buckets - 1); index[b]; b = (b + 1) & (buckets - 1))
+		{
+			const auto &rec = record[index[b] - 1];
+			if (cs == Str(rec.name))
+				return &rec;
+		}
+		return nullptr;
+	}
+
+	static uint32_t Bit(char m) { return (m >= 'A' && m <= 'Z') ? (1u << (m - 'A')) : 0u; }
+
+	// 32 bit FNV-1a
+	static uint32_t Hash(std::string_view s)
+	{
+		uint32_t h = 2166136261u;
+		for (auto c : s)
+		{
+			h ^= uint8_t(c);
+			h *= 16777619u;
+		}
+		return h;
+	}
+
+	static const uint32_t FileVersion = 1;
+
+private:
+	static const char *Magic() { return "MHD1"; }
+	static std::size_t FileSize(uint32_t records, uint32_t buckets, uint32_t strbytes)
+	{
+		return sizeof(SHostDbHeader) + 4 * std::size_t(buckets) + sizeof(SHostDbRecord) * std::size_t(records) + strbytes;
+	}
+
+	void *map = nullptr;
+	std::size_t size = 0;
+	std::time_t created = 0;
+	uint32_t records = 0, buckets = 0, strbytes = 0;
+	const uint32_t *index = nullptr;
+	const SHostDbRecord *record = nullptr;
+	const char *strings = nullptr;
+};
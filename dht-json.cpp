@@ -0,0 +1,106 @@
+/*
+ *   Copyright (c) 2026 by Thomas A. Early N7TAE
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "dht-json.h"
+
+void CJsonWriter::Prefix(const char *key)
+{
+	if (keyed)
+	{
+		keyed = false;
+		return;
+	}
+	if (! first.empty())
+	{
+		if (first.back())
+			first.back() = false;
+		else
+			buf.push_back(',');
+	}
+	if (key)
+	{
+		Quote(key);
+		buf.push_back(':');
+	}
+}
+
+void CJsonWriter::Quote(std::string_view s)
+{
+	static const char hex[] = "0123456789abcdef";
+	buf.push_back('"');
+	// copy runs of characters that don't need escaping all at once
+	auto run = s.begin();
+	for (auto it=s.begin(); it!=s.end(); it++)
+	{
+		const unsigned char c = *it;
+		if (c >= 0x20 && '"' != c && '\\' != c)
+			continue;
+		buf.append(run, it);
+		run = it + 1;
+		buf.push_back('\\');
+		switch (c)
+		{
+			case '"':  buf.push_back('"');  break;
+			case '\\': buf.push_back('\\'); break;
+			case '\b': buf.push_back('b');  break;
+			case '\f': buf.push_back('f');  break;
+			case '\n': buf.push_back('n');  break;
+			case '\r': buf.push_back('r');  break;
+			case '\t': buf.push_back('t');  break;
+			default:
+				buf.append("u00");
+				buf.push_back(hex[c >> 4]);
+				buf.push_back(hex[c & 0xf]);
+				break;
+		}
+	}
+	buf.append(run, s.end());
+	buf.push_back('"');
+}
+
+CJsonWriter &CJsonWriter::Time(const char *key, std::time_t t, bool use_local)
+{
+	// most times in a dump are the same few seconds, so keep the last one of each kind
+	struct SCache { std::time_t t; bool valid; char str[32]; std::size_t len; };
+	thread_local SCache cache[2] = {};
+	auto &c = cache[use_local ? 1 : 0];
+	if (! c.valid || c.t != t)
+	{
+		struct tm tm;
+		if (use_local)
+			c.len = strftime(c.str, sizeof(c.str), "%F %T %Z", localtime_r(&t, &tm));
+		else
+			c.len = strftime(c.str, sizeof(c.str), "%FT%TZ", gmtime_r(&t, &tm));
+		c.t = t;
+		c.valid = true;
+	}
+	Prefix(key);
+	buf.push_back('"');
+	buf.append(c.str, c.len);
+	buf.push_back('"');
+	return *this;
+}
+
+void CJsonWriter::Write(std::ostream &stream)
+{
+	if (buf.empty())
+		return;
+	stream.write(buf.data(), buf.size());
+	stream.flush();
+	buf.clear();
+}
@@ -0,0 +1,74 @@
+/*
+ *   Copyright (c) 2026 by Thomas A. Early N7TAE
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#pragma once
+
+#include <charconv>
+#include <ctime>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+// Builds json text in a buffer that is only ever appended to.
+// Commas are taken care of by the writer: inside an object every value needs a key, inside
+// an array or at the top level the key is nullptr. Strings are escaped, integers are formatted
+// with std::to_chars and time strings are only formatted once for each second.
+class CJsonWriter
+{
+public:
+	CJsonWriter &BeginObject(const char *key = nullptr) { Prefix(key); buf.push_back('{'); first.push_back(true); return *this; }
+	CJsonWriter &EndObject() { buf.push_back('}'); first.pop_back(); return *this; }
+	CJsonWriter &BeginArray(const char *key = nullptr)  { Prefix(key); buf.push_back('['); first.push_back(true); return *this; }
+	CJsonWriter &EndArray()  { buf.push_back(']'); first.pop_back(); return *this; }
+
+	// the key of the next value, when that value is written by somebody else
+	CJsonWriter &Key(const char *key) { Prefix(key); keyed = true; return *this; }
+
+	CJsonWriter &Str(const char *key, std::string_view s) { Prefix(key); Quote(s); return *this; }
+	CJsonWriter &Chr(const char *key, char c) { Prefix(key); Quote(std::string_view(&c, 1)); return *this; }
+	CJsonWriter &Bool(const char *key, bool b) { Prefix(key); buf.append(b ? "true" : "false"); return *this; }
+	template <typename I> CJsonWriter &Int(const char *key, I i)
+	{
+		static_assert(std::is_integral<I>::value, "Int() needs an integer");
+		Prefix(key);
+		char str[24];
+		auto r = std::to_chars(str, str + sizeof(str), i);
+		buf.append(str, r.ptr - str);
+		return *this;
+	}
+	// "%FT%TZ" in gmt, or "%F %T %Z" in local time
+	CJsonWriter &Time(const char *key, std::time_t t, bool use_local);
+
+	// ends a top level value, so the buffer is a sequence of json lines
+	CJsonWriter &EndLine() { buf.push_back('\n'); return *this; }
+
+	bool Empty() const { return buf.empty(); }
+	const std::string &Buffer() const { return buf; }
+	// writes the buffer with a single write() and clears it
+	void Write(std::ostream &stream);
+
+private:
+	void Prefix(const char *key);
+	void Quote(std::string_view s);
+
+	std::string buf;
+	std::vector<bool> first; // one for each open object or array, true until it has a value
+	bool keyed = false;      // Key() has already written the prefix of the next value
+};
@@ -0,0 +1,311 @@
+/*
+ *   Copyright (c) 2026 by Thomas A. Early N7TAE
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <opendht.h>
+#include <getopt.h>
+#include <csignal>
+#include <iostream>
+#include <string>
+#include <map>
+
+#include "dht-values.h"
+#include "dht-helpers.h"
+#include "dht-node.h"
+
+static const std::string default_bs("xrf757.openquad.net");
+static char section = 'a';
+static bool use_local = false;
+
+// what has been output so far, keyed by callsign
+// everything here is only touched by the listen callbacks, which all run on the node's thread
+static std::time_t clientsTime = 0, usersTime = 0;
+static unsigned clientsSeq = 0, usersSeq = 0;
+static dht::Blob clientsData, usersData;
+static std::map<std::string, MrefdClientTuple> clients;
+static std::map<std::string, std::time_t> heard;
+
+static void Usage(std::ostream &ostr, const char *comname)
+{
+	ostr << "usage: " << comname << " [-b bootstrap] [-s {c|u}] [-l] [--identity dir | --ephemeral] [--gateway url] node_name" << std::endl << std::endl;
+	ostr << "Listens for the Clients and Users sections of an M17 reflector and outputs a json line" << std::endl;
+	ostr << "whenever a client joins or leaves, or a user is heard. Stop it with Control-C." << std::endl;
+	ostr << "Options:" << std::endl;
+	ostr << "    -b (bootstrap) argument is any running node on the dht network, or a comma separated" << std::endl;
+	ostr << "       list of them, which are all tried at the same time." << std::endl;
+	ostr << "       If not specified, " << default_bs << " will be used." << std::endl;
+	ostr << "    -s (section) arguments is one of:" << std::endl;
+	ostr << "        c - clients" << std::endl;
+	ostr << "        u - users" << std::endl;
+	ostr << "        If no section is specified, both sections will be followed." << std::endl;
+	ostr << "    -l will output time values in local time, otherwise gmt is reported." << std::endl;
+	NodeUsage(ostr);
+}
+
+// true if the value carries exactly the same data as the last one, so there's nothing to do
+// comparing the raw data first means a republished value isn't even verified or unpacked
+static bool IsStale(const dht::Value &v, const dht::Blob &last)
+{
+	return v.data == last;
+}
+
+static void NewClients(const dht::Value &v)
+{
+	if (IsStale(v, clientsData) || ! v.checkSignature())
+		return;
+	auto rdat = dht::Value::unpack<SMrefdClients1>(v);
+	if (rdat.timestamp < clientsTime || (rdat.timestamp == clientsTime && rdat.sequence <= clientsSeq))
+		return;
+	clientsTime = rdat.timestamp;
+	clientsSeq = rdat.sequence;
+	clientsData = v.data;
+
+	std::map<std::string, MrefdClientTuple> now;
+	for (auto &c : rdat.list)
+	{
+		auto cs = std::get<toUType(EMrefdClientFields::Callsign)>(c);
+		now.emplace(std::move(cs), std::move(c));
+	}
+
+	// both maps are ordered by callsign, so a single merge finds who left and who joined
+	CJsonWriter json;
+	auto oit = clients.cbegin();
+	auto nit = now.cbegin();
+	while (oit != clients.cend() || nit != now.cend())
+	{
+		if (nit == now.cend() || (oit != clients.cend() && oit->first < nit->first))
+		{
+			json.BeginObject().Str("Event", "Left").Key("Client");
+			PrintMrefdClient(oit++->second, use_local, json);
+			json.EndObject().EndLine();
+		}
+		else if (oit == clients.cend() || nit->first < oit->first)
+		{
+			json.BeginObject().Str("Event", "Joined").Key("Client");
+			PrintMrefdClient(nit++->second, use_local, json);
+			json.EndObject().EndLine();
+		}
+		else
+		{
+			// the same callsign on a different module has left one and joined the other
+			const auto om = std::get<toUType(EMrefdClientFields::Module)>(oit->second);
+			const auto nm = std::get<toUType(EMrefdClientFields::Module)>(nit->second);
+			if (om != nm)
+			{
+				json.BeginObject().Str("Event", "Left").Key("Client");
+				PrintMrefdClient(oit->second, use_local, json);
+				json.EndObject().EndLine();
+				json.BeginObject().Str("Event", "Joined").Key("Client");
+				PrintMrefdClient(nit->second, use_local, json);
+				json.EndObject().EndLine();
+			}
+			oit++;
+			nit++;
+		}
+	}
+	clients = std::move(now);
+	json.Write(std::cout);
+}
+
+static void NewUsers(const dht::Value &v)
+{
+	if (IsStale(v, usersData) || ! v.checkSignature())
+		return;
+	auto rdat = dht::Value::unpack<SMrefdUsers1>(v);
+	if (rdat.timestamp < usersTime || (rdat.timestamp == usersTime && rdat.sequence <= usersSeq))
+		return;
+	usersTime = rdat.timestamp;
+	usersSeq = rdat.sequence;
+	usersData = v.data;
+
+	// the list is most recent first, so output it backwards to keep the lines in time order
+	CJsonWriter json;
+	for (auto uit=rdat.list.crbegin(); uit!=rdat.list.crend(); uit++)
+	{
+		const auto &src = std::get<toUType(EMrefdUserFields::Source)>(*uit);
+		const auto lh = std::get<toUType(EMrefdUserFields::LastHeardTime)>(*uit);
+		auto it = heard.find(src);
+		if (heard.end() == it || it->second < lh)
+		{
+			heard[src] = lh;
+			json.BeginObject().Str("Event", "Heard").Key("User");
+			PrintMrefdUser(*uit, use_local, json);
+			json.EndObject().EndLine();
+		}
+	}
+	json.Write(std::cout);
+}
+
+int main(int argc, char *argv[])
+{
+	std::string bs(default_bs);
+	SNodeOptions nodeopts;
+	static const struct option long_options[] = {
+		{ "identity",  required_argument, nullptr, OPT_IDENTITY  },
+		{ "ephemeral", no_argument,       nullptr, OPT_EPHEMERAL },
+		{ "gateway",   required_argument, nullptr, OPT_GATEWAY   },
+		{ "ready-nodes", required_argument, nullptr, OPT_READYNODES },
+		{ "ready-wait",  required_argument, nullptr, OPT_READYWAIT  },
+		{ nullptr, 0, nullptr, 0 }
+	};
+	while (1)
+	{
+		int c = getopt_long(argc, argv, "b:s:l", long_options, nullptr);
+		if (c < 0)
+		{
+			if (1 == argc)
+			{
+				Usage(std::cout, argv[0]);
+				exit(EXIT_SUCCESS);
+			}
+			break;
+		}
+
+		switch (c)
+		{
+			case 'b':
+			bs.assign(optarg);
+			break;
+
+			case 'l':
+			use_local = true;
+			break;
+
+			case 's':
+			section = optarg[0];
+			if (optarg[1] || ('c'!=section && 'u'!=section))
+			{
+				std::cerr << argv[0] << ": " << "You have specified an illegal section!" << std::endl;
+				Usage(std::cerr, argv[0]);
+				exit(EXIT_FAILURE);
+			}
+			break;
+
+			case OPT_IDENTITY:
+			nodeopts.statedir.assign(optarg);
+			break;
+
+			case OPT_EPHEMERAL:
+			nodeopts.ephemeral = true;
+			break;
+
+			case OPT_GATEWAY:
+			nodeopts.gateway.assign(optarg);
+			break;
+
+			case OPT_READYNODES:
+			nodeopts.readynodes = std::strtoul(optarg, nullptr, 10);
+			break;
+
+			case OPT_READYWAIT:
+			nodeopts.readywait = std::strtod(optarg, nullptr);
+			break;
+
+			default:
+			Usage(std::cerr, argv[0]);
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	if (optind + 1 != argc)
+	{
+		std::cerr << argv[0] << ": " << ((optind==argc) ? "No node_name specified!" : "Too many arguments!") << std::endl;
+		Usage(std::cerr, argv[0]);
+		exit(EXIT_FAILURE);
+	}
+
+	std::string key(argv[optind]);
+	for (auto &c : key)
+		c = std::toupper(c);
+	if (key.compare(0, 4, "M17-"))
+	{
+		std::cerr << "Only M17 reflectors publish their Clients and Users, can't listen to '" << key << "'" << std::endl;
+		return EXIT_FAILURE;
+	}
+	const auto keyhash = dht::InfoHash::get(key);
+
+	// block these before the node starts its threads, so only sigwait() will see them
+	sigset_t sigs;
+	sigemptyset(&sigs);
+	sigaddset(&sigs, SIGINT);
+	sigaddset(&sigs, SIGTERM);
+	pthread_sigmask(SIG_BLOCK, &sigs, nullptr);
+
+	dht::DhtRunner node;
+	try {
+		RunNode(node, "HamListen", bs, nodeopts);
+	} catch (const std::exception &ex) {
+		std::cout << argv[0] << " can't connect to the Ham-DHT! " << ex.what() << std::endl;
+		return 1;
+	}
+
+	std::shared_future<size_t> clientsToken, usersToken;
+	if ('u' != section)
+	{
+		dht::Where w;
+		w.id(toUType(EMrefdValueID::Clients));
+		clientsToken = node.listen(
+			keyhash,
+			[](const std::vector<std::shared_ptr<dht::Value>> &values, bool expired) {
+				if (! expired)
+				{
+					for (const auto &v : values)
+					{
+						if (0 == v->user_type.compare(MREFD_CLIENTS_1))
+							NewClients(*v);
+					}
+				}
+				return true;
+			},
+			{},	// empty filter
+			w
+		).share();
+	}
+	if ('c' != section)
+	{
+		dht::Where w;
+		w.id(toUType(EMrefdValueID::Users));
+		usersToken = node.listen(
+			keyhash,
+			[](const std::vector<std::shared_ptr<dht::Value>> &values, bool expired) {
+				if (! expired)
+				{
+					for (const auto &v : values)
+					{
+						if (0 == v->user_type.compare(MREFD_USERS_1))
+							NewUsers(*v);
+					}
+				}
+				return true;
+			},
+			{},	// empty filter
+			w
+		).share();
+	}
+
+	int sig;
+	sigwait(&sigs, &sig);
+
+	if (clientsToken.valid())
+		node.cancelListen(keyhash, clientsToken);
+	if (usersToken.valid())
+		node.cancelListen(keyhash, usersToken);
+	SaveNodes(node, nodeopts);
+	node.join();
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,314 @@
+/*
+ *   Copyright (c) 2026 by Thomas A. Early N7TAE
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pwd.h>
+#include <cerrno>
+#include <cstring>
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <thread>
+
+#include "dht-file.h"
+#include "dht-node.h"
+
+// identity file layout, all integers are in host byte order:
+//   4 bytes   magic
+//   uint32_t  size of the private key
+//   uint32_t  size of the certificate
+//   the private key, then the certificate, both as exported by OpenDHT
+static const char IdentityMagic[4] = { 'H', 'D', 'I', '1' };
+
+// shared by the resolver threads and the bootstrap callbacks, which can outlive Bootstrap()
+struct SBootRace
+{
+	std::mutex mtx;
+	dht::DhtRunner *node = nullptr; // set to nullptr by WaitReady(), so a late resolver leaves it alone
+	std::string winner; // the host, and address family, of the first address to answer
+	std::chrono::steady_clock::time_point start;
+};
+
+std::string DefaultStateDir()
+{
+	const char *home = getenv("HOME");
+	if (nullptr == home || 0 == *home)
+	{
+		auto pw = getpwuid(getuid());
+		if (nullptr == pw)
+			return std::string();
+		home = pw->pw_dir;
+	}
+	return std::string(home) + "/.ham-dht";
+}
+
+void NodeUsage(std::ostream &ostr)
+{
+	ostr << "    --identity dir is where the node identity and routing table are saved, default is " << DefaultStateDir() << std::endl;
+	ostr << "    --ephemeral will use a new identity that isn't saved" << std::endl;
+	ostr << "    --gateway url uses a running dht-gateway, like http://127.0.0.1:8000, instead of starting a node" << std::endl;
+	ostr << "    --ready-nodes n is how many good nodes the routing table needs before any get starts, default is 4" << std::endl;
+	ostr << "    --ready-wait secs is the most time to wait for them, default is 5" << std::endl;
+}
+
+// make the directory, and any missing parent directory
+static bool MakeDir(const std::string &dir)
+{
+	for (auto pos=dir.find('/', 1); ; pos=dir.find('/', pos+1))
+	{
+		const auto path = dir.substr(0, pos);
+		if (mkdir(path.c_str(), 0700) && EEXIST != errno)
+			return false;
+		if (std::string::npos == pos)
+			return true;
+	}
+}
+
+static bool ReadIdentity(const std::string &path, dht::crypto::Identity &id)
+{
+	auto fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+	struct stat sb;
+	if (fstat(fd, &sb) || sb.st_size < 12)
+	{
+		close(fd);
+		return false;
+	}
+	const size_t size = sb.st_size;
+	auto map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (MAP_FAILED == map)
+		return false;
+
+	bool rval = false;
+	const auto *data = static_cast<const uint8_t *>(map);
+	uint32_t keylen, certlen;
+	memcpy(&keylen, data+4, 4);
+	memcpy(&certlen, data+8, 4);
+	if (0 == memcmp(data, IdentityMagic, 4) && size == 12 + size_t(keylen) + size_t(certlen))
+	{
+		try {
+			id.first  = std::make_shared<dht::crypto::PrivateKey>(data+12, keylen);
+			id.second = std::make_shared<dht::crypto::Certificate>(data+12+keylen, certlen);
+			rval = true;
+		} catch (const std::exception &ex) {
+			std::cerr << "Could not read the identity in " << path << ": " << ex.what() << std::endl;
+		}
+	}
+	munmap(map, size);
+	return rval;
+}
+
+static bool WriteIdentity(const std::string &path, const dht::crypto::Identity &id)
+{
+	const auto key  = id.first->serialize();
+	const auto cert = id.second->getPacked();
+	const uint32_t keylen = key.size();
+	const uint32_t certlen = cert.size();
+
+	// the private key is in here, so only the owner can read it
+	return AtomicWrite(path, 0600, {
+		{ IdentityMagic, 4 },
+		{ &keylen, 4 },
+		{ &certlen, 4 },
+		{ key.data(), keylen },
+		{ cert.data(), certlen }
+	});
+}
+
+dht::crypto::Identity GetIdentity(const std::string &name, SNodeOptions &opts)
+{
+	const auto start = std::chrono::steady_clock::now();
+	dht::crypto::Identity id;
+	opts.idloaded = false;
+
+	if (opts.statedir.empty())
+		opts.statedir.assign(DefaultStateDir());
+
+	if (opts.ephemeral || opts.statedir.empty())
+	{
+		id = dht::crypto::generateIdentity(name + std::to_string(getpid()));
+	}
+	else
+	{
+		const std::string path(opts.statedir + "/" + name + ".id");
+		if (ReadIdentity(path, id))
+		{
+			opts.idloaded = true;
+		}
+		else
+		{
+			id = dht::crypto::generateIdentity(name);
+			if (! MakeDir(opts.statedir) || ! WriteIdentity(path, id))
+				std::cerr << "WARNING: could not save the node identity to " << path << ": " << strerror(errno) << std::endl;
+		}
+	}
+
+	opts.idmsecs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	return id;
+}
+
+void Bootstrap(dht::DhtRunner &node, const std::string &hosts, SNodeOptions &opts)
+{
+	if (opts.statedir.empty())
+		opts.statedir.assign(DefaultStateDir());
+
+	// the saved routing table is a msgpack'ed std::vector<dht::NodeExport>
+	std::ifstream ifile(opts.statedir + "/nodes", std::ios::binary);
+	if (ifile.is_open())
+	{
+		const std::string buf((std::istreambuf_iterator<char>(ifile)), std::istreambuf_iterator<char>());
+		ifile.close();
+		try {
+			auto oh = msgpack::unpack(buf.data(), buf.size());
+			auto nodes = oh.get().as<std::vector<dht::NodeExport>>();
+			if (nodes.size())
+			{
+				node.bootstrap(nodes);
+				opts.savednodes = true;
+			}
+		} catch (const std::exception &ex) {
+			std::cerr << "WARNING: ignoring the saved routing table: " << ex.what() << std::endl;
+		}
+	}
+
+	auto race = std::make_shared<SBootRace>();
+	race->node = &node;
+	race->start = std::chrono::steady_clock::now();
+	opts.race = race;
+
+	// none of these bootstraps block, so they are all in progress at the same time
+	std::string::size_type pos = 0;
+	while (pos <= hosts.size())
+	{
+		auto end = hosts.find(',', pos);
+		if (std::string::npos == end)
+			end = hosts.size();
+		const auto host = hosts.substr(pos, end - pos);
+		pos = end + 1;
+		if (host.empty())
+			continue;
+
+		std::thread([race, host]() {
+			std::vector<dht::SockAddr> addrs;
+			try {
+				addrs = dht::SockAddr::resolve(host, "17171");
+			} catch (const std::exception &ex) {
+				std::cerr << "WARNING: could not resolve " << host << ": " << ex.what() << std::endl;
+				return;
+			}
+			if (addrs.empty())
+			{
+				std::cerr << "WARNING: could not resolve " << host << std::endl;
+				return;
+			}
+			std::lock_guard<std::mutex> lck(race->mtx);
+			if (nullptr == race->node)
+				return;
+			// one bootstrap for each address, because a bootstrap of several addresses
+			// doesn't call back until every one of them has answered or timed out
+			for (const auto &addr : addrs)
+			{
+				const std::string who(host + ((AF_INET6 == addr.getFamily()) ? " over IPv6" : " over IPv4"));
+				race->node->bootstrap(addr, [race, who](bool ok) {
+					if (! ok)
+						return;
+					std::lock_guard<std::mutex> lck(race->mtx);
+					if (race->winner.empty())
+						race->winner.assign(who);
+				});
+			}
+		}).detach();
+	}
+}
+
+void WaitReady(dht::DhtRunner &node, SNodeOptions &opts)
+{
+	const auto start = opts.race ? opts.race->start : std::chrono::steady_clock::now();
+	const auto wait = std::chrono::milliseconds(long(1000.0 * opts.readywait));
+	while (true)
+	{
+		opts.goodnodes = node.getNodesStats(AF_INET).good_nodes + node.getNodesStats(AF_INET6).good_nodes;
+		if (opts.goodnodes >= opts.readynodes || std::chrono::steady_clock::now() - start >= wait)
+			break;
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	}
+	opts.readymsecs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	// a host that hasn't even resolved by now is left out, and the node is no longer touched by
+	// its resolver thread, so the tool is free to destroy the node whenever it likes
+	if (opts.race)
+	{
+		std::lock_guard<std::mutex> lck(opts.race->mtx);
+		opts.race->node = nullptr;
+		opts.winner = opts.race->winner;
+	}
+	// if none of the hosts answered, the routing table can only have come from the saved nodes
+	if (opts.goodnodes && opts.winner.empty() && opts.savednodes)
+		opts.winner.assign("the saved nodes");
+
+	const std::string from(opts.winner.empty() ? "no bootstrap host has answered yet" : "bootstrapped from " + opts.winner);
+	if (opts.goodnodes >= opts.readynodes && ! opts.winner.empty())
+		std::cerr << "Bootstrapped from " << opts.winner << ", " << opts.goodnodes << " good nodes after " << unsigned(opts.readymsecs) << " ms" << std::endl;
+	else if (opts.goodnodes >= opts.readynodes)
+		std::cerr << opts.goodnodes << " good nodes after " << unsigned(opts.readymsecs) << " ms, " << from << std::endl;
+	else
+		std::cerr << "WARNING: only " << opts.goodnodes << " good nodes after " << unsigned(opts.readymsecs) << " ms, " << from << std::endl;
+}
+
+void RunNode(dht::DhtRunner &node, const std::string &name, const std::string &hosts, SNodeOptions &opts)
+{
+	if (opts.gateway.empty())
+	{
+		node.run(17171, GetIdentity(name, opts), true, 59973);
+		Bootstrap(node, hosts, opts);
+		WaitReady(node, opts);
+		return;
+	}
+
+	// the identity is still read, it's needed for the statedir and it's what the node signs with
+	dht::DhtRunner::Config config;
+	config.dht_config.node_config.network = 59973;
+	config.dht_config.id = GetIdentity(name, opts);
+	config.threaded = true;
+	config.proxy_server = opts.gateway;
+	node.run(0, config);
+}
+
+void SaveNodes(dht::DhtRunner &node, const SNodeOptions &opts)
+{
+	// a gateway client has no routing table of its own
+	if (opts.statedir.empty() || ! opts.gateway.empty())
+		return;
+	const auto nodes = node.exportNodes();
+	if (nodes.empty())
+		return;
+	if (! MakeDir(opts.statedir))
+		return;
+
+	// every tool shares this file
+	msgpack::sbuffer buf;
+	msgpack::pack(buf, nodes);
+	AtomicWrite(opts.statedir + "/nodes", 0644, { { buf.data(), buf.size() } });
+}
@@ -0,0 +1,76 @@
+/*
+ *   Copyright (c) 2026 by Thomas A. Early N7TAE
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#pragma once
+
+#include <opendht.h>
+#include <memory>
+#include <string>
+#include <iostream>
+
+// getopt_long() values for the options that every tool shares
+enum { OPT_IDENTITY = 0x100, OPT_EPHEMERAL, OPT_GATEWAY, OPT_READYNODES, OPT_READYWAIT };
+
+struct SBootRace;
+
+// how a tool should get the identity of its node, and how its node got started
+struct SNodeOptions
+{
+	std::string statedir;   // where the identity and routing table are kept, set by --identity
+	bool ephemeral = false; // --ephemeral generates a throw-away identity that is not saved
+	std::string gateway;    // --gateway is the url of a dht-gateway, the tool doesn't run its own node
+	unsigned readynodes = 4; // --ready-nodes is how many good nodes the routing table needs before the gets start
+	double readywait = 5.0; // --ready-wait is the most seconds to wait for them
+	double idmsecs = 0.0;   // how long it took to get the identity
+	bool idloaded = false;  // true if the identity was read from statedir
+	bool savednodes = false; // true if the routing table saved by the last run was loaded
+	std::string winner;     // the bootstrap host, and address family, that answered first
+	double readymsecs = 0.0; // how long it took for the routing table to be ready
+	unsigned goodnodes = 0; // the number of good nodes in the routing table when it was ready
+	std::shared_ptr<SBootRace> race; // the bootstraps that are still in progress
+};
+
+// $HOME/.ham-dht, or an empty string if there is no home directory
+extern std::string DefaultStateDir();
+
+// print the options above for a tool's usage message
+extern void NodeUsage(std::ostream &ostr);
+
+// returns the identity for the node named 'name'
+// unless opts.ephemeral is set, the identity is read from <statedir>/<name>.id
+// the first time a tool is run, a new identity is generated and saved there
+extern dht::crypto::Identity GetIdentity(const std::string &name, SNodeOptions &opts);
+
+// bootstrap from the nodes saved by the last run, if any, and from hosts at the same time
+// hosts is a comma separated list, every host is resolved on its own thread and all of its
+// IPv4 and IPv6 addresses are pinged at once, so a slow or dead host doesn't hold up the rest
+extern void Bootstrap(dht::DhtRunner &node, const std::string &hosts, SNodeOptions &opts);
+
+// wait until the routing table has opts.readynodes good nodes, so a get() can find something,
+// or until opts.readywait seconds have gone by, then report the winning bootstrap and the time it took on stderr
+// Bootstrap() must be followed by WaitReady() before the node is destroyed
+extern void WaitReady(dht::DhtRunner &node, SNodeOptions &opts);
+
+// start the node named 'name', bootstrap it from hosts and wait until it's ready
+// with opts.gateway, the node is a client of that gateway instead, so it doesn't bind 17171 and
+// doesn't bootstrap, it uses the gateway's routing table, which is already warm
+extern void RunNode(dht::DhtRunner &node, const std::string &name, const std::string &hosts, SNodeOptions &opts);
+
+// save the nodes in the routing table to <statedir>/nodes so the next run starts warm
+// call this before node.join()
+extern void SaveNodes(dht::DhtRunner &node, const SNodeOptions &opts);
@@ -0,0 +1,75 @@
+/*
+ *   Copyright (c) 2026 by Thomas A. Early N7TAE
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <string>
+#include <streambuf>
+#include <condition_variable>
+
+// A std::streambuf that one thread writes chunks into while another thread reads them
+// through a std::istream. A read blocks until the next chunk arrives, or the writer calls
+// Close(), which is the end of the stream. Each chunk is handed over whole, so nothing is
+// copied except into the chunk itself.
+class CStreamPipe : public std::streambuf
+{
+public:
+	void Write(const char *data, std::size_t len)
+	{
+		if (0 == len)
+			return;
+		std::lock_guard<std::mutex> lck(mtx);
+		chunks.emplace_back(data, len);
+		cv.notify_one();
+	}
+
+	// no more chunks are coming, the reader sees the end of the stream once it has read them all
+	void Close()
+	{
+		std::lock_guard<std::mutex> lck(mtx);
+		closed = true;
+		cv.notify_one();
+	}
+
+protected:
+	int_type underflow() override
+	{
+		if (gptr() < egptr())
+			return traits_type::to_int_type(*gptr());
+		std::unique_lock<std::mutex> lck(mtx);
+		while (chunks.empty() && ! closed)
+			cv.wait(lck);
+		if (chunks.empty())
+			return traits_type::eof();
+		current = std::move(chunks.front());
+		chunks.pop_front();
+		lck.unlock();
+		auto p = &current[0];
+		setg(p, p, p + current.size());
+		return traits_type::to_int_type(*gptr());
+	}
+
+private:
+	std::mutex mtx;
+	std::condition_variable cv;
+	std::deque<std::string> chunks;
+	std::string current; // the chunk being read
+	bool closed = false;
+};
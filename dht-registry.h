@@ -0,0 +1,98 @@
+/*
+ *   Copyright (c) 2026 by Thomas A. Early N7TAE
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#pragma once
+
+#include <tuple>
+#include <cstring>
+#include <type_traits>
+
+#include "dht-values.h"
+
+// the dht::Value id and user_type of each part, so a value can be matched to its struct
+// before it's unpacked. a new part, or a new version of a part, only needs a new entry here
+template <typename T> struct SValueTraits;
+
+#ifdef USE_MREFD_VALUES
+template <> struct SValueTraits<SMrefdConfig1>  { static constexpr uint64_t id = toUType(EMrefdValueID::Config);  static constexpr const char *user_type = MREFD_CONFIG_1;  };
+template <> struct SValueTraits<SMrefdPeers1>   { static constexpr uint64_t id = toUType(EMrefdValueID::Peers);   static constexpr const char *user_type = MREFD_PEERS_1;   };
+template <> struct SValueTraits<SMrefdClients1> { static constexpr uint64_t id = toUType(EMrefdValueID::Clients); static constexpr const char *user_type = MREFD_CLIENTS_1; };
+template <> struct SValueTraits<SMrefdUsers1>   { static constexpr uint64_t id = toUType(EMrefdValueID::Users);   static constexpr const char *user_type = MREFD_USERS_1;   };
+#endif
+
+#ifdef USE_URFD_VALUES
+template <> struct SValueTraits<SUrfdConfig1>   { static constexpr uint64_t id = toUType(EUrfdValueID::Config);   static constexpr const char *user_type = URFD_CONFIG_1;   };
+template <> struct SValueTraits<SUrfdPeers1>    { static constexpr uint64_t id = toUType(EUrfdValueID::Peers);    static constexpr const char *user_type = URFD_PEERS_1;    };
+#endif
+
+// parts that are published more than once a second also have a sequence number
+template <typename T, typename = void> struct HasSequence : std::false_type {};
+template <typename T> struct HasSequence<T, std::void_t<decltype(std::declval<T>().sequence)>> : std::true_type {};
+
+// the newest value wins: a later timestamp, or the same timestamp and a higher sequence
+template <typename T> bool IsNewer(const T &a, const T &b)
+{
+	if (a.timestamp != b.timestamp)
+		return a.timestamp > b.timestamp;
+	if constexpr (HasSequence<T>::value)
+		return a.sequence > b.sequence;
+	else
+		return false;
+}
+
+enum class EAccept { unknown, newer, superseded };
+
+// the newest value received for each of the parts T...
+// a value is matched on its id and user_type, unpacked once and moved into place if it's newer
+// a part that hasn't been received has a zero timestamp
+template <typename... T> class CValueSet
+{
+public:
+	// unknown:    the value isn't one of the parts
+	// newer:      the value is now the newest of its part
+	// superseded: a newer (or the same) value of its part has already been received
+	EAccept Accept(const dht::Value &v)
+	{
+		EAccept rval = EAccept::unknown;
+		(void)(Match<T>(v, rval) || ...);
+		return rval;
+	}
+
+	template <typename U> const U &Get() const { return std::get<U>(values); }
+	template <typename U> U &Get() { return std::get<U>(values); }
+	template <typename U> bool Has() const { return 0 != std::get<U>(values).timestamp; }
+
+private:
+	template <typename U> bool Match(const dht::Value &v, EAccept &rval)
+	{
+		if (v.id != SValueTraits<U>::id || v.user_type.compare(SValueTraits<U>::user_type))
+			return false;
+		auto rdat = dht::Value::unpack<U>(v);
+		auto &current = std::get<U>(values);
+		if (IsNewer(rdat, current))
+		{
+			current = std::move(rdat);
+			rval = EAccept::newer;
+		}
+		else
+			rval = EAccept::superseded;
+		return true;
+	}
+
+	std::tuple<T...> values {};
+};
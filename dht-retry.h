@@ -0,0 +1,116 @@
+/*
+ *   Copyright (c) 2026 by Thomas A. Early N7TAE
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <functional>
+#include <condition_variable>
+
+// reissues a get that failed or came back empty, after a jittered exponential backoff
+// retry n waits a random time between half and all of base * 2^n, but never more than cap,
+// so a burst of empty gets doesn't come back all at once
+// the reissue is called on the retrier's own thread, so a done callback never has to wait
+class CRetrier
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	// tries is the most times any one get is retried, zero turns retrying off
+	CRetrier(unsigned tries, std::chrono::milliseconds base = std::chrono::milliseconds(500), std::chrono::milliseconds cap = std::chrono::milliseconds(8000))
+		: tries(tries), base(base), cap(cap), rng(std::random_device()())
+	{
+		if (tries)
+			thread = std::thread([this]() { Run(); });
+	}
+	~CRetrier() { Stop(); }
+
+	// attempt is the number of times the get has already been retried
+	// returns false if the get has no tries left, or the retrier has been stopped,
+	// and the caller should finish the lookup with what it has
+	bool Retry(unsigned attempt, std::function<void()> reissue)
+	{
+		std::lock_guard<std::mutex> lck(mtx);
+		if (stopped || attempt >= tries)
+			return false;
+		const auto limit = std::min(cap.count(), base.count() << std::min(attempt, 20u));
+		std::uniform_int_distribution<std::chrono::milliseconds::rep> jitter(limit / 2, limit);
+		due.emplace(Clock::now() + std::chrono::milliseconds(jitter(rng)), std::move(reissue));
+		retries++;
+		cv.notify_all();
+		return true;
+	}
+
+	// drops every retry that hasn't been issued yet, call this once every lookup is finished
+	// and before node.join(), a later Retry() returns false
+	void Stop()
+	{
+		{
+			std::lock_guard<std::mutex> lck(mtx);
+			stopped = true;
+			due.clear();
+			cv.notify_all();
+		}
+		if (thread.joinable())
+			thread.join();
+	}
+
+	unsigned Tries() const { return tries; }
+	unsigned Retries() const { return retries; }
+
+private:
+	void Run()
+	{
+		std::unique_lock<std::mutex> lck(mtx);
+		while (! stopped)
+		{
+			if (due.empty())
+			{
+				cv.wait(lck);
+				continue;
+			}
+			const auto next = due.begin()->first;
+			if (Clock::now() < next)
+			{
+				cv.wait_until(lck, next);
+				continue;
+			}
+			auto reissue = std::move(due.begin()->second);
+			due.erase(due.begin());
+			lck.unlock();
+			reissue();
+			lck.lock();
+		}
+	}
+
+	const unsigned tries;
+	const std::chrono::milliseconds base, cap;
+	std::mt19937 rng;
+	std::mutex mtx;
+	std::condition_variable cv;
+	std::multimap<Clock::time_point, std::function<void()>> due;
+	std::atomic<unsigned> retries { 0 };
+	bool stopped = false;
+	std::thread thread;
+};
@@ -0,0 +1,274 @@
+/*
+ *   Copyright (c) 2026 by Thomas A. Early N7TAE
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+#include "dht-file.h"
+#include "dht-snapshot.h"
+
+// snapshot file layout, all integers are in host byte order:
+//   SHeader
+//   int64_t   connect time of each link
+//   uint32_t  string offset of each name, plus one for the end of the last name
+//   uint32_t  first link of each reflector, plus one for the end of the last reflector
+//   uint32_t  target of each link
+//   uint32_t  module bitset of each link
+//   uint8_t   1 if each reflector's Peers were received
+//   the names, one after the other without any terminator
+// the header is a multiple of 8 bytes, so every array is aligned in the mapped file
+static const char SnapshotMagic[4] = { 'H', 'D', 'S', '1' };
+static const uint32_t SnapshotVersion = 1;
+
+struct SHeader
+{
+	char magic[4];
+	uint32_t version;
+	int64_t created;
+	uint32_t names, links, strbytes, module;
+};
+static_assert(32 == sizeof(SHeader), "the snapshot header must not have any padding");
+
+static std::size_t FileSize(uint32_t names, uint32_t links, uint32_t strbytes)
+{
+	return sizeof(SHeader) + 8 * std::size_t(links) + 8 * (std::size_t(names) + 1) + 8 * std::size_t(links) + names + strbytes;
+}
+
+bool CSnapshot::Write(const std::string &path, const CPeerGraph &graph, char module)
+{
+	const uint32_t n = graph.Size();
+	const uint32_t l = n ? graph.End(n-1) : 0;
+
+	std::vector<int64_t> connect(l);
+	std::vector<uint32_t> nameoff(n+1), linkoff(n+1), target(l), mask(l);
+	std::vector<uint8_t> received(n);
+	std::string strings;
+	for (uint32_t id=0; id<n; id++)
+	{
+		nameoff[id] = uint32_t(strings.size());
+		strings.append(graph.Name(id));
+		linkoff[id] = graph.Begin(id);
+		received[id] = graph.Received(id) ? 1 : 0;
+	}
+	nameoff[n] = uint32_t(strings.size());
+	linkoff[n] = l;
+	for (uint32_t i=0; i<l; i++)
+	{
+		connect[i] = graph.Connect(i);
+		target[i] = graph.Target(i);
+		mask[i] = graph.Modules(i);
+	}
+
+	SHeader header;
+	memcpy(header.magic, SnapshotMagic, 4);
+	header.version = SnapshotVersion;
+	header.created = std::time(nullptr);
+	header.names = n;
+	header.links = l;
+	header.strbytes = uint32_t(strings.size());
+	header.module = uint32_t(module);
+
+	return AtomicWrite(path, 0644, {
+		{ &header, sizeof(header) },
+		{ connect.data(), 8 * connect.size() },
+		{ nameoff.data(), 4 * nameoff.size() },
+		{ linkoff.data(), 4 * linkoff.size() },
+		{ target.data(), 4 * target.size() },
+		{ mask.data(), 4 * mask.size() },
+		{ received.data(), received.size() },
+		{ strings.data(), strings.size() }
+	});
+}
+
+bool CSnapshot::Open(const std::string &path, std::string &error)
+{
+	Close();
+	error.clear();
+	auto fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+	{
+		error.assign(strerror(errno));
+		return false;
+	}
+	struct stat sb;
+	if (fstat(fd, &sb) || std::size_t(sb.st_size) < sizeof(SHeader))
+	{
+		close(fd);
+		error.assign("too short to be a snapshot");
+		return false;
+	}
+	size = sb.st_size;
+	map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (MAP_FAILED == map)
+	{
+		map = nullptr;
+		error.assign(strerror(errno));
+		return false;
+	}
+
+	const auto *data = static_cast<const uint8_t *>(map);
+	SHeader header;
+	memcpy(&header, data, sizeof(header));
+	if (memcmp(header.magic, SnapshotMagic, 4))
+		error.assign("not a snapshot");
+	else if (SnapshotVersion != header.version)
+		error.assign("unsupported snapshot version " + std::to_string(header.version));
+	else if (size != FileSize(header.names, header.links, header.strbytes))
+		error.assign("the snapshot has the wrong size");
+	if (! error.empty())
+	{
+		Close();
+		return false;
+	}
+
+	names   = header.names;
+	links   = header.links;
+	created = header.created;
+	module  = char(header.module);
+	auto p = data + sizeof(SHeader);
+	connect  = reinterpret_cast<const int64_t *>(p);  p += 8 * std::size_t(links);
+	nameoff  = reinterpret_cast<const uint32_t *>(p); p += 4 * (std::size_t(names) + 1);
+	linkoff  = reinterpret_cast<const uint32_t *>(p); p += 4 * (std::size_t(names) + 1);
+	target   = reinterpret_cast<const uint32_t *>(p); p += 4 * std::size_t(links);
+	mask     = reinterpret_cast<const uint32_t *>(p); p += 4 * std::size_t(links);
+	received = p;                                      p += names;
+	strings  = reinterpret_cast<const char *>(p);
+
+	// the accessors trust the offsets, so check every one of them now
+	bool ok = 0 == nameoff[0] && header.strbytes == nameoff[names] && 0 == linkoff[0] && links == linkoff[names];
+	for (uint32_t id=0; ok && id<names; id++)
+		ok = nameoff[id] <= nameoff[id+1] && linkoff[id] <= linkoff[id+1];
+	for (uint32_t i=0; ok && i<links; i++)
+		ok = target[i] < names;
+	if (! ok)
+	{
+		error.assign("the snapshot is corrupt");
+		Close();
+	}
+	return ok;
+}
+
+void CSnapshot::Close()
+{
+	if (map)
+		munmap(map, size);
+	map = nullptr;
+	size = 0;
+	names = links = 0;
+}
+
+static std::string ModuleString(uint32_t mask)
+{
+	std::string s;
+	for (char m='A'; m<='Z'; m++)
+	{
+		if (mask & CPeerGraph::Bit(m))
+			s.push_back(m);
+	}
+	return s;
+}
+
+// the links of one reflector that changed, 'a' and 'b' are its ids in each snapshot or none
+// both rows are sorted by target, and the ids of both snapshots are in callsign order, so
+// mapping the old targets to new ids keeps them in order and the rows are simply merged
+static unsigned DiffLinks(const CSnapshot &from, uint32_t a, const CSnapshot &to, uint32_t b, const std::vector<uint32_t> &a2b, std::ostream &ostr)
+{
+	// a reflector that was in a snapshot but didn't answer has unknown links, so they can't be compared
+	if ((CPeerGraph::none != a && ! from.Received(a)) || (CPeerGraph::none != b && ! to.Received(b)))
+		return 0;
+
+	unsigned count = 0;
+	auto report = [&](const char *sign, uint32_t target, bool old, uint32_t modules)
+	{
+		if (0 == modules)
+			return;
+		ostr << "link " << sign << ' ' << (old ? from.Name(a) : to.Name(b)) << ' ' << (old ? from.Name(target) : to.Name(target)) << ' ' << ModuleString(modules) << '\n';
+		count++;
+	};
+
+	uint32_t i = (CPeerGraph::none == a) ? 0 : from.Begin(a), iend = (CPeerGraph::none == a) ? 0 : from.End(a);
+	uint32_t j = (CPeerGraph::none == b) ? 0 : to.Begin(b),   jend = (CPeerGraph::none == b) ? 0 : to.End(b);
+	while (i < iend || j < jend)
+	{
+		const auto mapped = (i < iend) ? a2b[from.Target(i)] : CPeerGraph::none;
+		if (i < iend && (CPeerGraph::none == mapped || j == jend || mapped < to.Target(j)))
+		{
+			// only in the old snapshot, even if the target reflector vanished
+			report("-", from.Target(i), true, from.Modules(i));
+			i++;
+			continue;
+		}
+		if (i == iend || mapped > to.Target(j))
+		{
+			report("+", to.Target(j), false, to.Modules(j));
+			j++;
+			continue;
+		}
+		// the same link, only its modules might have changed
+		report("+", to.Target(j), false, to.Modules(j) & ~from.Modules(i));
+		report("-", to.Target(j), false, from.Modules(i) & ~to.Modules(j));
+		i++;
+		j++;
+	}
+	return count;
+}
+
+unsigned DiffSnapshots(const CSnapshot &from, const CSnapshot &to, std::ostream &ostr)
+{
+	// match the reflectors by name, both are in callsign order
+	std::vector<uint32_t> a2b(from.Size(), CPeerGraph::none);
+	for (uint32_t a=0, b=0; a<from.Size() && b<to.Size(); )
+	{
+		const auto c = from.Name(a).compare(to.Name(b));
+		if (c < 0)
+			a++;
+		else if (c > 0)
+			b++;
+		else
+			a2b[a++] = b++;
+	}
+
+	unsigned count = 0;
+	uint32_t a = 0, b = 0;
+	while (a < from.Size() || b < to.Size())
+	{
+		if (b == to.Size() || (a < from.Size() && CPeerGraph::none == a2b[a] && from.Name(a) < to.Name(b)))
+		{
+			ostr << "reflector - " << from.Name(a) << '\n';
+			count++;
+			count += DiffLinks(from, a++, to, CPeerGraph::none, a2b, ostr);
+		}
+		else if (a == from.Size() || a2b[a] != b)
+		{
+			ostr << "reflector + " << to.Name(b) << '\n';
+			count++;
+			count += DiffLinks(from, CPeerGraph::none, to, b++, a2b, ostr);
+		}
+		else
+		{
+			count += DiffLinks(from, a++, to, b++, a2b, ostr);
+		}
+	}
+	return count;
+}
@@ -0,0 +1,76 @@
+/*
+ *   Copyright (c) 2026 by Thomas A. Early N7TAE
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+#include "dht-graph.h"
+
+// A CPeerGraph saved to a file that is read back with mmap(), without any DHT access.
+// The file has the same arrays as the graph, so a snapshot is used just like the graph
+// it was made from, straight out of the mapped file.
+class CSnapshot
+{
+public:
+	CSnapshot() = default;
+	CSnapshot(const CSnapshot &) = delete;
+	CSnapshot &operator=(const CSnapshot &) = delete;
+	~CSnapshot() { Close(); }
+
+	// module is the one that was crawled, or '*' for every module
+	static bool Write(const std::string &path, const CPeerGraph &graph, char module);
+
+	// false, with the reason in 'error', if the file can't be read or isn't a snapshot
+	bool Open(const std::string &path, std::string &error);
+	void Close();
+
+	std::time_t Created() const { return created; }
+	char Module() const { return module; }
+
+	uint32_t Size() const { return names; }
+	std::string_view Name(uint32_t id) const { return std::string_view(strings + nameoff[id], nameoff[id+1] - nameoff[id]); }
+	bool Received(uint32_t id) const { return 0 != received[id]; }
+	uint32_t Begin(uint32_t id) const { return linkoff[id]; }
+	uint32_t End(uint32_t id) const { return linkoff[id+1]; }
+	uint32_t Target(uint32_t link) const { return target[link]; }
+	uint32_t Modules(uint32_t link) const { return mask[link]; }
+	std::time_t Connect(uint32_t link) const { return connect[link]; }
+
+private:
+	void *map = nullptr;
+	std::size_t size = 0;
+	std::time_t created = 0;
+	char module = 0;
+	uint32_t names = 0, links = 0;
+	const int64_t  *connect  = nullptr;
+	const uint32_t *nameoff  = nullptr;
+	const uint32_t *linkoff  = nullptr;
+	const uint32_t *target   = nullptr;
+	const uint32_t *mask     = nullptr;
+	const uint8_t  *received = nullptr;
+	const char     *strings  = nullptr;
+};
+
+// reports the reflectors and links that are in one snapshot but not the other, in time
+// proportional to the size of the snapshots, and returns the number of differences
+unsigned DiffSnapshots(const CSnapshot &from, const CSnapshot &to, std::ostream &ostr);
@@ -17,165 +17,279 @@
  */
 
 #include <opendht.h>
+#include <getopt.h>
+#include <csignal>
 #include <iostream>
 #include <set>
 #include <map>
-#include <list>
-#include <atomic>
+#include <vector>
+#include <algorithm>
+#include <iomanip>
+#include <cerrno>
+#include <cstring>
 
 #include "dht-values.h"
+#include "dht-crawl.h"
+#include "dht-graph.h"
+#include "dht-snapshot.h"
+#include "dht-stats.h"
+#include "dht-follow.h"
+#include "dht-json.h"
+#include "dht-node.h"
 
 static const std::string default_bs("xlx757.openquad.net");
-static dht::Where w;
-SMrefdPeers1 mrefdPeers;
-SUrfdPeers1  urfdPeers;
-static std::map<std::string, std::set<std::string>> Web;
-static std::atomic<bool> ready;
+static const unsigned default_window = 8;
+static const unsigned default_retries = 3;
 
-static void Trim(std::string &s)
+enum { OPT_DEADLINE = 0x200, OPT_MAXNODES, OPT_MAXDEPTH };
+
+static void Usage(std::ostream &ostr, const char *comname)
+{
+	ostr << "usage: " << comname << " [-b bootstrap] [-j gets] [-r tries] [-l] [-f] [-w snapshot] [--stats] [--identity dir | --ephemeral] [--gateway url] node_name module" << std::endl;
+	ostr << "       " << comname << " -a [-b bootstrap] [-j gets] [-r tries] [-l] [-f] [-w snapshot] [--stats] [--identity dir | --ephemeral] [--gateway url] node_name" << std::endl;
+	ostr << "       " << comname << " -d old_snapshot new_snapshot" << std::endl << std::endl;
+	ostr << "Options:" << std::endl;
+	ostr << "    -a crawl every module of every reflector that can be reached from node_name and" << std::endl;
+	ostr << "       report the groups of linked reflectors and the one-way links on each module" << std::endl;
+	ostr << "    -b (bootstrap) argument is any running node on the dht network, or a comma separated" << std::endl;
+	ostr << "       list of them, which are all tried at the same time." << std::endl;
+	ostr << "    -l to only print the list of linked peers" << std::endl;
+	ostr << "       If not specified, " << default_bs << " will be used." << std::endl;
+	ostr << "    -j the maximum number of peer lookups in flight, default is " << default_window << std::endl;
+	ostr << "    -r the most times a reflector whose peers didn't arrive is looked up again, default is " << default_retries << std::endl;
+	ostr << "    --deadline secs stops the crawl after this many seconds, abandoning the lookups in flight" << std::endl;
+	ostr << "    --max-nodes n stops the crawl after n reflectors have been looked up" << std::endl;
+	ostr << "    --max-depth n only crawls reflectors within n links of node_name" << std::endl;
+	ostr << "       When a limit is reached, the reflectors that weren't looked up are marked with a '?'" << std::endl;
+	ostr << "    -w save a snapshot of the crawl to the file argument" << std::endl;
+	ostr << "    -f keep following the peers of every reflector after the crawl. SIGUSR1 outputs the current" << std::endl;
+	ostr << "       result (and saves the snapshot), SIGUSR2 outputs it as a single json line" << std::endl;
+	ostr << "    -d report the reflectors and links that changed between two snapshots, no dht is used" << std::endl;
+	ostr << "       The exit status is 0 if nothing changed, 1 if something did and 2 if there was an error." << std::endl;
+	ostr << "    --stats outputs where the time went, and what happened to the values, as json on stderr" << std::endl;
+	NodeUsage(ostr);
+}
+
+// the reflectors the crawl reached on the module: the seed and every peer listed on it, in alphabetical order
+static std::vector<uint32_t> Reached(const CPeerGraph &graph, const char module, const std::string &key)
 {
-	while (! s.empty())
+	std::vector<bool> reached(graph.Size(), false);
+	const auto seed = graph.Find(key);
+	if (CPeerGraph::none != seed)
+		reached[seed] = true;
+	for (uint32_t id=0; id<graph.Size(); id++)
 	{
-		if (isspace(s.at(0)))
-			s.erase(0, 1);
-		else if (isspace(s.back()))
+		for (auto l=graph.Begin(id); l<graph.End(id); l++)
 		{
-			s.resize(s.size()-1);
+			if (graph.Modules(l) & CPeerGraph::Bit(module))
+				reached[graph.Target(l)] = true;
 		}
-		else
-			break;
 	}
+	std::vector<uint32_t> group;
+	for (uint32_t id=0; id<graph.Size(); id++)
+	{
+		if (reached[id])
+			group.push_back(id);
+	}
+	return group;
 }
 
-static void FindPeers(dht::DhtRunner &node, const std::string &refcs, const char module, const bool isM17)
+// the connect matrix of the reflectors that share the module
+static void PrintMatrix(const CPeerGraph &graph, const char module, const std::string &key, const bool isM17)
 {
-	mrefdPeers.timestamp = 0;
-	mrefdPeers.sequence = 0;
-	mrefdPeers.list.clear();
-	ready = false;
-	node.get(
-		dht::InfoHash::get(refcs),
-		[](const std::shared_ptr<dht::Value> &v)
+	const auto group = Reached(graph, module, key);
+
+	const std::string space(isM17 ? 9 : 8, ' ');
+	std::cout << space << std::string(2*group.size()+1, '=') << std::endl;
+	std::vector<char> row(graph.Size());
+	for (const auto r : group)
+	{
+		// mark this row's peers once, instead of looking up every column
+		std::fill(row.begin(), row.end(), ' ');
+		for (auto l=graph.Begin(r); l<graph.End(r); l++)
 		{
-			if (v->checkSignature())
-			{
-				if (0 == v->user_type.compare(MREFD_PEERS_1))
-				{
-					auto rdat = dht::Value::unpack<SMrefdPeers1>(*v);
-					if (rdat.timestamp > mrefdPeers.timestamp)
-					{
-						mrefdPeers = dht::Value::unpack<SMrefdPeers1>(*v);
-					}
-					else if (rdat.timestamp == mrefdPeers.timestamp)
-					{
-						if (rdat.sequence > mrefdPeers.sequence)
-							mrefdPeers = dht::Value::unpack<SMrefdPeers1>(*v);
-					}
-				}
-				else if (0 == v->user_type.compare(URFD_PEERS_1))
-				{
-					auto rdat = dht::Value::unpack<SUrfdPeers1>(*v);
-					if (rdat.timestamp > urfdPeers.timestamp)
-					{
-						urfdPeers = dht::Value::unpack<SUrfdPeers1>(*v);
-					}
-					else if (rdat.timestamp == urfdPeers.timestamp)
-					{
-						if (rdat.sequence > urfdPeers.sequence)
-							urfdPeers = dht::Value::unpack<SUrfdPeers1>(*v);
-					}
-				}
+			if (graph.Modules(l) & CPeerGraph::Bit(module))
+				row[graph.Target(l)] = '+';
+		}
+		row[r] = graph.Degree(r, module) ? '=' : '?';
 
-			}
-			else
-			{
-				std::cout << "Value signature failed!" << std::endl;
-			}
-			return true;
-		},
-		[](bool success)
+		std::cout << graph.Name(r) << " |";
+		for (const auto c : group)
+			std::cout << ' ' << row[c];
+		std::cout << " | " << graph.Name(r).substr(isM17 ? 4 : 3) << std::endl;
+	}
+	std::cout << space << std::string(2*group.size()+1, '=') << std::endl;
+	for (int i=0; i<3; i++)
+	{
+		std::cout << space;
+		for (const auto id : group)
 		{
-			if (!success)
-			{
-				std::cerr << "get() failed!" << std::endl;
-			}
-			ready = true;
-		},
-		{}, // empty filter
-		w
-	);
-
-	// wait for node.get() to complete
-	while (! ready)
+			int j = i + (isM17 ? 4 : 3);
+			std::cout << ' ' << graph.Name(id).at(j);
+		}
+		std::cout << std::endl;
+	}
+}
+
+// the groups of linked reflectors on each module, and the links only one side reports
+static void PrintNetwork(const CPeerGraph &graph)
+{
+	uint32_t answered = 0;
+	for (uint32_t id=0; id<graph.Size(); id++)
 	{
-		// a bit of a hack, but it works!
-		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		if (graph.Received(id))
+			answered++;
 	}
+	std::cout << graph.Size() << " reflectors found, " << answered << " answered" << std::endl;
 
-	// add the webnode to the map
-	std::set<std::string> peerset;
-	if (isM17)
+	for (char module='A'; module<='Z'; module++)
 	{
-		for (const auto &p : mrefdPeers.list)
+		if (0 == (graph.AllModules() & CPeerGraph::Bit(module)))
+			continue;
+
+		// group the members of each component, the component id is its first member
+		const auto comp = graph.Components(module);
+		std::map<uint32_t, std::vector<uint32_t>> groups;
+		for (uint32_t id=0; id<graph.Size(); id++)
 		{
-			const auto modules = std::get<toUType(EMrefdPeerFields::Modules)>(p);
-			if (std::string::npos != modules.find(module)) // add only if the peer is using this module
-			{
-				auto ref = std::get<toUType(EMrefdPeerFields::Callsign)>(p);
-				Trim(ref);
-				auto rval = peerset.insert(ref);
-				if (false == rval.second)
-					std::cout << "WARNING: " << ref << "could not be added to the " << refcs << " mrefdPeers!" << std::endl;
-			}
+			if (CPeerGraph::none != comp[id])
+				groups[comp[id]].push_back(id);
+		}
+		std::cout << "Module " << module << ": " << groups.size() << " group" << ((1 == groups.size()) ? "" : "s") << std::endl;
+		for (const auto &g : groups)
+		{
+			std::cout << "   ";
+			for (const auto id : g.second)
+				std::cout << ' ' << graph.Name(id);
+			std::cout << std::endl;
 		}
+		for (const auto &a : graph.Asymmetric(module))
+			std::cout << "    one-way: " << graph.Name(a.first) << " lists " << graph.Name(a.second) << " but " << graph.Name(a.second) << " doesn't list " << graph.Name(a.first) << std::endl;
 	}
-	else
+
+	bool first = true;
+	for (uint32_t id=0; id<graph.Size(); id++)
 	{
-		for (const auto &p : urfdPeers.list)
+		if (! graph.Received(id))
 		{
-			const auto modules = std::get<toUType(EUrfdPeerFields::Modules)>(p);
-			if (std::string::npos != modules.find(module)) // add only if the peer is using this module
-			{
-				auto ref = std::get<toUType(EUrfdPeerFields::Callsign)>(p);
-				Trim(ref);
-				auto rval = peerset.insert(ref);
-				if (false == rval.second)
-					std::cout << "WARNING: " << ref << "could not be added to the " << refcs << " urfdPeers!" << std::endl;
-			}
+			std::cout << (first ? "No peers received from:" : "") << ' ' << graph.Name(id);
+			first = false;
 		}
 	}
-	auto rval = Web.emplace(refcs, peerset);
-	if (false == rval.second)
+	if (! first)
+		std::cout << std::endl;
+}
+
+// output a crawl, and save its snapshot
+static void Report(const CPeerGraph &graph, const std::string &key, const char module, const bool isM17, const bool onlylist, const std::string &snapshot)
+{
+	if (snapshot.size() && ! CSnapshot::Write(snapshot, graph, module))
+		std::cerr << "WARNING: could not save the snapshot to " << snapshot << ": " << strerror(errno) << std::endl;
+
+	if (onlylist)
 	{
-		std::cerr << "ERROR: Could not create Web map item for " << refcs << std::endl;
-		exit(EXIT_FAILURE);
+		if ('*' == module)
+		{
+			// every reflector that was found has been crawled, ids are in alphabetical order
+			for (uint32_t id=0; id<graph.Size(); id++)
+				std::cout << graph.Name(id) << std::endl;
+		}
+		else
+		{
+			for (const auto id : Reached(graph, module, key))
+				std::cout << graph.Name(id) << std::endl;
+		}
+	}
+	else if ('*' == module)
+	{
+		PrintNetwork(graph);
+	}
+	else
+	{
+		PrintMatrix(graph, module, key, isM17);
 	}
+}
 
-	// now, keep looking via this recursive call
-	for (const auto &pstr : Web[refcs])
+// the whole graph as a single json line
+static void PrintJson(const CPeerGraph &graph)
+{
+	CJsonWriter json;
+	json.BeginObject().Time("Time", std::time(nullptr), false).BeginArray("Reflectors");
+	for (uint32_t id=0; id<graph.Size(); id++)
 	{
-		if (Web.end() == Web.find(pstr))	// if it hasn't already been added...
-			FindPeers(node, pstr, module, isM17);	// then add it!
+		json.BeginObject().Str("Callsign", graph.Name(id)).Bool("Received", graph.Received(id));
+		json.BeginArray("Peers");
+		for (auto l=graph.Begin(id); l<graph.End(id); l++)
+		{
+			std::string modules;
+			for (char m='A'; m<='Z'; m++)
+			{
+				if (graph.Modules(l) & CPeerGraph::Bit(m))
+					modules.push_back(m);
+			}
+			json.BeginObject()
+				.Str("Callsign", graph.Name(graph.Target(l)))
+				.Str("Modules", modules)
+				.Time("ConnectTime", graph.Connect(l), false)
+				.EndObject();
+		}
+		json.EndArray().EndObject();
 	}
+	json.EndArray().EndObject().EndLine();
+	json.Write(std::cout);
 }
 
-static void Usage(std::ostream &ostr, const char *comname)
+// compare two snapshots, returns the exit status
+static int Diff(const char *oldpath, const char *newpath)
 {
-	ostr << "usage: " << comname << " [-b bootstrap] [-l] node_name module" << std::endl << std::endl;
-	ostr << "Options:" << std::endl;
-	ostr << "    -b (bootstrap) argument is any running node on the dht network" << std::endl;
-	ostr << "    -l to only print the list of linked peers" << std::endl;
-	ostr << "       If not specified, " << default_bs << " will be used." << std::endl;
+	CSnapshot from, to;
+	std::string error;
+	if (! from.Open(oldpath, error))
+	{
+		std::cerr << "Error: can't read " << oldpath << ": " << error << std::endl;
+		return 2;
+	}
+	if (! to.Open(newpath, error))
+	{
+		std::cerr << "Error: can't read " << newpath << ": " << error << std::endl;
+		return 2;
+	}
+	if (from.Module() != to.Module())
+		std::cerr << "WARNING: the snapshots are of different crawls, module " << from.Module() << " and module " << to.Module() << std::endl;
+	const auto count = DiffSnapshots(from, to, std::cout);
+	std::cout.flush();
+	return count ? 1 : 0;
 }
 
 int main(int argc, char *argv[])
 {
+	const auto start = CStats::Clock::now();
 	bool onlylist = false;
+	bool allmods = false;
+	bool diff = false;
+	bool follow = false;
+	std::string snapshot;
+	unsigned window = default_window;
+	unsigned tries = default_retries;
+	SCrawlLimits limits;
 	// parse the command line
 	std::string bs(default_bs);
+	SNodeOptions nodeopts;
+	static const struct option long_options[] = {
+		{ "identity",  required_argument, nullptr, OPT_IDENTITY  },
+		{ "ephemeral", no_argument,       nullptr, OPT_EPHEMERAL },
+		{ "gateway",   required_argument, nullptr, OPT_GATEWAY   },
+		{ "stats",     no_argument,       nullptr, OPT_STATS     },
+		{ "ready-nodes", required_argument, nullptr, OPT_READYNODES },
+		{ "ready-wait",  required_argument, nullptr, OPT_READYWAIT  },
+		{ "deadline",  required_argument, nullptr, OPT_DEADLINE  },
+		{ "max-nodes", required_argument, nullptr, OPT_MAXNODES  },
+		{ "max-depth", required_argument, nullptr, OPT_MAXDEPTH  },
+		{ nullptr, 0, nullptr, 0 }
+	};
 	while (1)
 	{
-		int c = getopt(argc, argv, "b:l");
+		int c = getopt_long(argc, argv, "ab:dfj:lr:w:", long_options, nullptr);
 		if (c < 0)
 		{
 			if (1 == argc)
@@ -188,12 +302,75 @@ int main(int argc, char *argv[])
 
 		switch (c)
 		{
+		case 'a':
+			allmods = true;
+			break;
 		case 'b':
 			bs.assign(optarg);
 			break;
+		case 'd':
+			diff = true;
+			break;
+		case 'f':
+			follow = true;
+			break;
+		case OPT_STATS:
+			stats.Enable();
+			break;
+		case 'r':
+			tries = std::strtoul(optarg, nullptr, 10);
+			break;
+		case 'j':
+			window = std::strtoul(optarg, nullptr, 10);
+			if (0 == window)
+			{
+				std::cerr << "Error: -j must be at least 1!" << std::endl;
+				Usage(std::cerr, argv[0]);
+				exit(EXIT_FAILURE);
+			}
+			break;
 		case 'l':
 			onlylist = true;
 			break;
+		case 'w':
+			snapshot.assign(optarg);
+			break;
+		case OPT_IDENTITY:
+			nodeopts.statedir.assign(optarg);
+			break;
+		case OPT_EPHEMERAL:
+			nodeopts.ephemeral = true;
+			break;
+		case OPT_GATEWAY:
+			nodeopts.gateway.assign(optarg);
+			break;
+		case OPT_READYNODES:
+			nodeopts.readynodes = std::strtoul(optarg, nullptr, 10);
+			break;
+		case OPT_READYWAIT:
+			nodeopts.readywait = std::strtod(optarg, nullptr);
+			break;
+		case OPT_DEADLINE:
+			limits.deadline = std::chrono::milliseconds(long(1000.0 * std::strtod(optarg, nullptr)));
+			if (limits.deadline.count() <= 0)
+			{
+				std::cerr << "Error: --deadline must be more than 0 seconds!" << std::endl;
+				Usage(std::cerr, argv[0]);
+				exit(EXIT_FAILURE);
+			}
+			break;
+		case OPT_MAXNODES:
+			limits.maxnodes = std::strtoul(optarg, nullptr, 10);
+			if (0 == limits.maxnodes)
+			{
+				std::cerr << "Error: --max-nodes must be at least 1!" << std::endl;
+				Usage(std::cerr, argv[0]);
+				exit(EXIT_FAILURE);
+			}
+			break;
+		case OPT_MAXDEPTH:
+			limits.maxdepth = std::strtoul(optarg, nullptr, 10);
+			break;
 
 		default:
 			Usage(std::cerr, argv[0]);
@@ -201,9 +378,20 @@ int main(int argc, char *argv[])
 		}
 	}
 
-	if (optind + 2 != argc)
+	if (diff)
 	{
-		std::cerr << "Error: " << argv[0] << " needs two arguments!" << std::endl;
+		if (optind + 2 != argc)
+		{
+			std::cerr << "Error: -d needs two snapshots!" << std::endl;
+			Usage(std::cerr, argv[0]);
+			exit(2);
+		}
+		return Diff(argv[optind], argv[optind+1]);
+	}
+
+	if (optind + (allmods ? 1 : 2) != argc)
+	{
+		std::cerr << "Error: " << argv[0] << " needs " << (allmods ? "one argument" : "two arguments") << '!' << std::endl;
 		Usage(std::cerr, argv[0]);
 		exit(EXIT_FAILURE);
 	}
@@ -218,24 +406,40 @@ int main(int argc, char *argv[])
 	const std::string key(argv[optind]);
 	const auto isM17 = 0 == key.compare(0, 4, "M17-");
 
-	p = argv[++optind];
-	if (1 != std::strlen(p) || ! std::isalpha(*p))
+	char module = '*';
+	if (! allmods)
 	{
-		std::cerr << "Error: second argument must specify a single module!" << std::endl;
-		Usage(std::cerr, argv[0]);
-		exit(EXIT_FAILURE);
+		p = argv[++optind];
+		if (1 != std::strlen(p) || ! std::isalpha(*p))
+		{
+			std::cerr << "Error: second argument must specify a single module!" << std::endl;
+			Usage(std::cerr, argv[0]);
+			exit(EXIT_FAILURE);
+		}
+		module = std::toupper(*p);
 	}
-
-	const char module = std::toupper(*p);
 	// command line parsing done
 
+	// block these before the node starts its threads, so only sigwait() will see them
+	sigset_t sigs;
+	sigemptyset(&sigs);
+	if (follow)
+	{
+		sigaddset(&sigs, SIGINT);
+		sigaddset(&sigs, SIGTERM);
+		sigaddset(&sigs, SIGUSR1);
+		sigaddset(&sigs, SIGUSR2);
+		pthread_sigmask(SIG_BLOCK, &sigs, nullptr);
+	}
+
 	// log into the dht
-	std::string name("Spider");
-	name += std::to_string(getpid());
+	const std::string name("Spider");
+	CRetrier retrier(tries);
+	CVerifier verifier;	// declared first, so it outlives the node's callbacks
 	dht::DhtRunner node;
 	try {
-		node.run(17171, dht::crypto::generateIdentity(name), true, 59973);
-		node.bootstrap(bs, "17171");
+		RunNode(node, name, bs, nodeopts);
+		verifier.Load(nodeopts.statedir);
 	} catch (const std::exception &ex) {
 		std::cout << argv[0] << " can't connect to the Ham-DHT! " << ex.what() << std::endl;
 		return 1;
@@ -243,64 +447,75 @@ int main(int argc, char *argv[])
 	if (! onlylist)
 	{
 		std::cout << "Running node using name " << name << " and bootstrapping from " << bs << std::endl;
-		std::cout << "Shared module " << module << " map:" << std::endl;
+		std::cout << "Node identity " << (nodeopts.idloaded ? "loaded" : "generated") << " in " << std::fixed << std::setprecision(1) << nodeopts.idmsecs << " ms" << std::endl;
+		if (allmods)
+			std::cout << "All modules:" << std::endl;
+		else
+			std::cout << "Shared module " << module << " map:" << std::endl;
 	}
 
-	// set up the where condition
-	w.id(isM17 ? toUType(EMrefdValueID::Peers) : toUType(EUrfdValueID::Peers));
+	stats.Phase("identity", nodeopts.idmsecs);
+	stats.Phase("bootstrap", nodeopts.readymsecs);
 
 	// start the spider
-	FindPeers(node, key, module, isM17);
-
-	// make a list of all the reflectors which were found to be interconnected
-	// the list will be in alphabetical order because std::map is ordered by each item's key
-	std::list<std::string> group;
-	for (const auto &row : Web)
+	CCrawler crawler(node, verifier, module, isM17, window);
+	crawler.Limit(limits);
+	crawler.Retry(retrier);
+	const auto crawl = stats.Start();
+	crawler.Run(key);
+	stats.Phase("crawl", crawl);
+	retrier.Stop();
+	switch (crawler.Limited())
 	{
-		group.push_back(row.first);
+		case ECrawlLimit::deadline: std::cerr << "The deadline passed before the crawl finished" << std::endl; break;
+		case ECrawlLimit::nodes:    std::cerr << "The crawl stopped after looking up " << limits.maxnodes << " reflectors" << std::endl; break;
+		case ECrawlLimit::depth:    std::cerr << "The crawl stopped at a depth of " << limits.maxdepth << std::endl; break;
+		default: break;
 	}
-	if (onlylist)
+	const auto output = stats.Start();
+	Report(CPeerGraph(crawler.GetLinks()), key, module, isM17, onlylist, snapshot);
+	stats.Phase("output", output);
+	if (! onlylist)
 	{
-		for (const auto &p : group)
-		{
-			std::cout << p << std::endl;
-		}
+		std::cout << "Signatures: " << verifier.Hits() << " cached, " << verifier.Misses() << " verified, " << verifier.Failures() << " failed" << std::endl;
+		std::cout << "Lookups retried: " << retrier.Retries() << std::endl;
 	}
-	else
+
+	// keep the graph up to date until we're told to stop
+	CPeerFollower follower(node, verifier, module, isM17);
+	if (follow)
 	{
-		// now print the connect matrix
-		const std::string space(isM17 ? 9 : 8, ' ');
-		std::cout << space << std::string(2*Web.size()+1, '=') << std::endl;
-		for (const auto &row : group)
+		follower.Follow(crawler.GetLinks(), key);
+		std::cerr << "Following " << crawler.GetLinks().size() << " reflectors, send SIGUSR1 for the current " << (onlylist ? "list" : (allmods ? "groups" : "map")) << ", SIGUSR2 for json, Control-C to stop" << std::endl;
+		while (true)
 		{
-			std::cout << row << " |";
-			for (const auto &col : group)
-			{
-				if (row == col)
-				{
-					std::cout << ' ' << ((Web[row].size()) ? '=' : '?');
-				}
-				else
-				{
-					std::cout << ' ' << ((Web[row].end() == Web[row].find(col)) ? ' ' : '+');
-				}
-			}
-			std::cout << " | " << row.substr(isM17 ? 4 : 3) << std::endl;
-		}
-		std::cout << space << std::string(2*Web.size()+1, '=') << std::endl;
-		for (int i=0; i<3; i++)
-		{
-			std::cout << space;
-			for (const auto &ref : group)
-			{
-				int j = i + (isM17 ? 4 : 3);
-				std::cout << ' ' << ref.at(j);
-			}
-			std::cout << std::endl;
+			int sig;
+			sigwait(&sigs, &sig);
+			if (SIGUSR1 == sig)
+				Report(follower.Graph(), key, module, isM17, onlylist, snapshot);
+			else if (SIGUSR2 == sig)
+				PrintJson(follower.Graph());
+			else
+				break;
 		}
+		follower.Stop();
 	}
 
+	verifier.Save();
+	SaveNodes(node, nodeopts);
 	node.join();
+	verifier.Stop(); // the follower can still have values waiting to be checked
+
+	stats.Count("good_nodes", nodeopts.goodnodes);
+	stats.Count("reflectors", crawler.GetLinks().size());
+	stats.Count("signatures_cached", verifier.Hits());
+	stats.Count("signatures_verified", verifier.Misses());
+	stats.Count("signatures_failed", verifier.Failures());
+	stats.Count("retries", retrier.Retries());
+	if (follow)
+		stats.Count("updates", follower.Updates());
+	stats.Phase("total", start);
+	stats.Write(std::cerr);
 
 	return EXIT_SUCCESS;
 }
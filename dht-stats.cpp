@@ -0,0 +1,135 @@
+/*
+ *   Copyright (c) 2026 by Thomas A. Early N7TAE
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "dht-stats.h"
+#include "dht-json.h"
+
+CStats stats;
+
+void CStats::Phase(const char *name, Clock::time_point start)
+{
+	if (enabled)
+		Phase(name, std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+}
+
+void CStats::Phase(const char *name, double msecs)
+{
+	if (! enabled)
+		return;
+	const auto d = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(msecs));
+	std::lock_guard<std::mutex> lck(mtx);
+	for (auto &p : phases)
+	{
+		if (0 == p.first.compare(name))
+		{
+			p.second += d;
+			return;
+		}
+	}
+	phases.emplace_back(name, d);
+}
+
+void CStats::Latency(Clock::time_point start)
+{
+	if (! enabled)
+		return;
+	const int64_t nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+	gets++;
+	getnanos += nanos;
+	auto max = maxnanos.load();
+	while (nanos > max && ! maxnanos.compare_exchange_weak(max, nanos))
+		;
+	// bucket 0 is under 1 ms, bucket n is under 2^n ms
+	unsigned b = 0;
+	for (auto ms = nanos / 1000000; ms && b < buckets - 1; ms >>= 1)
+		b++;
+	histogram[b]++;
+}
+
+void CStats::Accepted(EAccept a, Clock::time_point start)
+{
+	if (! enabled)
+		return;
+	unpacknanos += std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+	switch (a)
+	{
+		case EAccept::newer:      newer++;      break;
+		case EAccept::superseded: superseded++; break;
+		case EAccept::unknown:    unknown++;    break;
+	}
+}
+
+void CStats::Count(const char *name, uint64_t value)
+{
+	if (! enabled)
+		return;
+	std::lock_guard<std::mutex> lck(mtx);
+	counts.emplace_back(name, value);
+}
+
+void CStats::Write(std::ostream &ostr)
+{
+	if (! enabled)
+		return;
+	auto us = [](int64_t nanos) { return nanos / 1000; };
+	std::lock_guard<std::mutex> lck(mtx);
+	CJsonWriter json;
+	json.BeginObject();
+
+	json.BeginObject("phases_us");
+	for (const auto &p : phases)
+		json.Int(p.first.c_str(), us(std::chrono::duration_cast<std::chrono::nanoseconds>(p.second).count()));
+	json.Int("unpack", us(unpacknanos));
+	json.EndObject();
+
+	json.BeginObject("gets");
+	json.Int("count", gets.load());
+	json.Int("mean_us", gets ? us(getnanos / gets) : 0);
+	json.Int("max_us", us(maxnanos));
+	// only the buckets with something in them, each with its upper bound; the last one is open, so it has its lower bound
+	json.BeginArray("histogram");
+	for (unsigned b=0; b<buckets; b++)
+	{
+		if (0 == histogram[b])
+			continue;
+		json.BeginObject();
+		if (b < buckets - 1)
+			json.Int("under_ms", 1u << b);
+		else
+			json.Int("over_ms", 1u << (buckets - 2));
+		json.Int("count", histogram[b].load());
+		json.EndObject();
+	}
+	json.EndArray();
+	json.EndObject();
+
+	json.BeginObject("values");
+	json.Int("received", received.load());
+	json.Int("newer", newer.load());
+	json.Int("superseded", superseded.load());
+	json.Int("unknown", unknown.load());
+	json.EndObject();
+
+	json.BeginObject("counts");
+	for (const auto &c : counts)
+		json.Int(c.first.c_str(), c.second);
+	json.EndObject();
+
+	json.EndObject().EndLine();
+	json.Write(ostr);
+}
@@ -0,0 +1,81 @@
+/*
+ *   Copyright (c) 2026 by Thomas A. Early N7TAE
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <utility>
+#include <iostream>
+
+#include "dht-registry.h"
+
+// the getopt_long() value of --stats, for the tools that have it
+enum { OPT_STATS = 0x180 };
+
+// Where a run spent its time, and what happened to the values it received.
+// Nothing is recorded until Enable() is called, so without --stats every call is a test
+// of a bool, and Start() doesn't even read the clock.
+class CStats
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	void Enable() { enabled = true; }
+	bool Enabled() const { return enabled; }
+
+	// the start of anything that is timed
+	Clock::time_point Start() const { return enabled ? Clock::now() : Clock::time_point(); }
+
+	// phases are reported in the order they are first recorded, a phase recorded again adds up
+	void Phase(const char *name, Clock::time_point start);
+	// for a phase that was timed somewhere else
+	void Phase(const char *name, double msecs);
+
+	// the time from a node.get() to its done callback
+	void Latency(Clock::time_point start);
+
+	// a value arrived in a get() or listen() callback, before its signature was checked
+	void Received() { if (enabled) received++; }
+	// what CValueSet::Accept() made of a verified value, and how long it took to unpack
+	void Accepted(EAccept a, Clock::time_point start);
+
+	// any other count worth reporting, like the verifier's
+	void Count(const char *name, uint64_t value);
+
+	// everything as one json line
+	void Write(std::ostream &ostr);
+
+private:
+	static const unsigned buckets = 20; // the last bucket is everything over 2^18 ms
+
+	bool enabled = false;
+	std::mutex mtx;
+	std::vector<std::pair<std::string, Clock::duration>> phases;
+	std::vector<std::pair<std::string, uint64_t>> counts;
+	std::atomic<unsigned> histogram[buckets] {};
+	std::atomic<unsigned> gets { 0 };
+	std::atomic<int64_t> getnanos { 0 }, maxnanos { 0 }, unpacknanos { 0 };
+	std::atomic<unsigned> received { 0 }, newer { 0 }, superseded { 0 }, unknown { 0 };
+};
+
+// there's one of these for the whole tool
+extern CStats stats;
@@ -0,0 +1,182 @@
+/*
+ *   Copyright (c) 2026 by Thomas A. Early N7TAE
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <unistd.h>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+#include "dht-file.h"
+#include "dht-verify.h"
+
+CVerifier::CVerifier(unsigned threads)
+{
+	if (0 == threads)
+		threads = 1;
+	for (unsigned i=0; i<threads; i++)
+		workers.emplace_back(&CVerifier::Worker, this);
+}
+
+void CVerifier::Stop()
+{
+	{
+		std::lock_guard<std::mutex> lck(mtx);
+		stop = true;
+	}
+	cv.notify_all();
+	for (auto &t : workers)
+		t.join();
+	workers.clear();
+}
+
+// the cache file is simply a list of 20-byte keys
+void CVerifier::Load(const std::string &statedir)
+{
+	if (statedir.empty())
+		return;
+	path.assign(statedir + "/verified");
+	std::ifstream ifile(path, std::ios::binary);
+	if (! ifile.is_open())
+		return;
+	dht::InfoHash key;
+	std::lock_guard<std::mutex> lck(mtx);
+	while (ifile.read(reinterpret_cast<char *>(key.data()), key.size()))
+		known.insert(key);
+}
+
+void CVerifier::Save()
+{
+	std::lock_guard<std::mutex> lck(mtx);
+	if (path.empty() || used.empty())
+		return;
+	// only what this run used is kept, so values that are no longer published age out
+	std::vector<SChunk> chunks;
+	chunks.reserve(used.size());
+	for (const auto &key : used)
+		chunks.push_back({ key.data(), key.size() });
+	AtomicWrite(path, 0644, chunks);
+}
+
+// everything that the signature covers, plus the signature itself
+dht::InfoHash CVerifier::Key(const dht::Value &v)
+{
+	dht::Blob b;
+	b.reserve(20 + 8 + 2 + v.data.size() + v.signature.size());
+	const auto owner = v.owner->getId();
+	b.insert(b.end(), owner.begin(), owner.end());
+	const auto id = reinterpret_cast<const uint8_t *>(&v.id);
+	b.insert(b.end(), id, id + sizeof(v.id));
+	const auto seq = reinterpret_cast<const uint8_t *>(&v.seq);
+	b.insert(b.end(), seq, seq + sizeof(v.seq));
+	b.insert(b.end(), v.data.begin(), v.data.end());
+	b.insert(b.end(), v.signature.begin(), v.signature.end());
+	return dht::InfoHash::get(b);
+}
+
+void CVerifier::Check(const std::shared_ptr<dht::Value> &v, Accept accept)
+{
+	if (! v->owner)
+	{
+		// an unsigned value can't be verified
+		failures++;
+		std::cerr << "Value signature failed!" << std::endl;
+		return;
+	}
+	const auto key = Key(*v);
+
+	std::unique_lock<std::mutex> lck(mtx);
+	if (used.count(key) || known.count(key))
+	{
+		used.insert(key);
+		lck.unlock();
+		hits++;
+		std::lock_guard<std::mutex> alck(acceptmtx);
+		accept(v);
+		return;
+	}
+	misses++;
+	const auto ticket = ++next;
+	pending.insert(ticket);
+	jobs.push_back(SJob { ticket, key, v, std::move(accept) });
+	lck.unlock();
+	cv.notify_one();
+}
+
+void CVerifier::Then(std::function<void()> done)
+{
+	std::unique_lock<std::mutex> lck(mtx);
+	if (pending.empty() || *pending.begin() > next)
+	{
+		lck.unlock();
+		done();
+		return;
+	}
+	fences.emplace(next, std::move(done));
+}
+
+// run every fence whose tickets have all finished, the lock is released while they run
+void CVerifier::RunFences(std::unique_lock<std::mutex> &lck)
+{
+	std::vector<std::function<void()>> ready;
+	const auto oldest = pending.empty() ? next + 1 : *pending.begin();
+	for (auto it=fences.begin(); it!=fences.end() && it->first<oldest; it=fences.erase(it))
+		ready.push_back(std::move(it->second));
+	if (ready.empty())
+		return;
+	lck.unlock();
+	for (auto &done : ready)
+		done();
+	lck.lock();
+}
+
+void CVerifier::Worker()
+{
+	std::unique_lock<std::mutex> lck(mtx);
+	while (true)
+	{
+		// anything still queued at exit belongs to a lookup that was abandoned
+		if (stop)
+			return;
+		if (jobs.empty())
+		{
+			cv.wait(lck);
+			continue;
+		}
+		auto job = std::move(jobs.front());
+		jobs.pop_front();
+		lck.unlock();
+
+		const bool good = job.value->checkSignature();
+		if (good)
+		{
+			std::lock_guard<std::mutex> alck(acceptmtx);
+			job.accept(job.value);
+		}
+		else
+		{
+			failures++;
+			std::cerr << "Value signature failed!" << std::endl;
+		}
+
+		lck.lock();
+		if (good)
+			used.insert(job.key);
+		pending.erase(job.ticket);
+		RunFences(lck);
+	}
+}
@@ -0,0 +1,94 @@
+/*
+ *   Copyright (c) 2026 by Thomas A. Early N7TAE
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#pragma once
+
+#include <opendht.h>
+#include <set>
+#include <map>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <functional>
+#include <condition_variable>
+
+// Checks value signatures off of the node's callback thread.
+// A value that has already been verified, in this run or in an earlier run when a
+// state directory is used, is recognized by a hash of its owner, id, seq, data and
+// signature, and isn't verified again. Everything else is verified on a small pool
+// of worker threads.
+class CVerifier
+{
+public:
+	using Accept = std::function<void(const std::shared_ptr<dht::Value> &)>;
+
+	explicit CVerifier(unsigned threads = 2);
+	~CVerifier() { Stop(); }
+
+	// joins the workers, checks that haven't started and the Then()s waiting on them are dropped
+	// call it after node.join() when a lookup might have been abandoned while it was still being checked
+	void Stop();
+
+	// read the values verified by earlier runs from <statedir>/verified
+	void Load(const std::string &statedir);
+	// save every value that was verified or used this run, call this at exit
+	void Save();
+
+	// accept is called with the value if its signature is good: right away if the
+	// value has already been verified, otherwise later from a worker thread
+	// accept callbacks never run at the same time as each other
+	void Check(const std::shared_ptr<dht::Value> &v, Accept accept);
+
+	// done is called once every Check() that was made before this call has finished
+	// use it in a get()'s done callback in place of the work that the done callback did
+	void Then(std::function<void()> done);
+
+	unsigned Hits()     const { return hits; }
+	unsigned Misses()   const { return misses; }
+	unsigned Failures() const { return failures; }
+
+private:
+	struct SJob
+	{
+		uint64_t ticket;
+		dht::InfoHash key;
+		std::shared_ptr<dht::Value> value;
+		Accept accept;
+	};
+
+	static dht::InfoHash Key(const dht::Value &v);
+	void Worker();
+	void RunFences(std::unique_lock<std::mutex> &lck);
+
+	std::mutex mtx, acceptmtx;
+	std::condition_variable cv;
+	std::deque<SJob> jobs;
+	std::set<uint64_t> pending;   // the tickets of jobs that are queued or running
+	std::multimap<uint64_t, std::function<void()>> fences; // each waits for all the tickets up to its key
+	uint64_t next = 0;
+	bool stop = false;
+	std::vector<std::thread> workers;
+
+	std::set<dht::InfoHash> known; // verified by an earlier run
+	std::set<dht::InfoHash> used;  // verified or recognized by this run
+	std::string path;
+
+	std::atomic<unsigned> hits { 0 }, misses { 0 }, failures { 0 };
+};
@@ -0,0 +1,326 @@
+/*
+ *   Copyright (c) 2026 by Thomas A. Early N7TAE
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#pragma once
+
+#include <string_view>
+#include <iterator>
+
+#include "dht-values.h"
+
+// Read-only views of the parts in dht-values.h.
+// A view unpacks the msgpack structure of a dht::Value but not its strings: every
+// std::string_view it returns points straight into dht::Value::data, and the tuple
+// lists are only decoded one item at a time as they are iterated. The dht::Value must
+// outlive its view. When an owning copy is really needed, Copy() returns the struct.
+//
+// Views are only valid if the value has the right user_type, check IsValid() before using one.
+
+class CValueView
+{
+public:
+	bool IsValid() const { return nullptr != fields; }
+
+	// strings are referenced, not copied into the msgpack zone
+	static bool Reference(msgpack::type::object_type type, std::size_t, void *)
+	{
+		return msgpack::type::STR == type || msgpack::type::BIN == type;
+	}
+
+	static std::string_view Str(const msgpack::object &o)
+	{
+		if (msgpack::type::STR == o.type)
+			return std::string_view(o.via.str.ptr, o.via.str.size);
+		return std::string_view();
+	}
+
+	static int64_t Int(const msgpack::object &o)
+	{
+		switch (o.type)
+		{
+			case msgpack::type::POSITIVE_INTEGER: return int64_t(o.via.u64);
+			case msgpack::type::NEGATIVE_INTEGER: return o.via.i64;
+			default: return 0;
+		}
+	}
+
+	static bool Bool(const msgpack::object &o)
+	{
+		return msgpack::type::BOOLEAN == o.type && o.via.boolean;
+	}
+
+protected:
+	CValueView() = default;
+
+	// size is the number of fields in the MSGPACK_DEFINE of the part
+	void Unpack(const dht::Value &v, const char *user_type, uint32_t size)
+	{
+		fields = nullptr;
+		if (v.user_type.compare(user_type))
+			return;
+		try {
+			oh = msgpack::unpack(reinterpret_cast<const char *>(v.data.data()), v.data.size(), &CValueView::Reference);
+		} catch (const std::exception &) {
+			return;
+		}
+		const auto &o = oh.get();
+		if (msgpack::type::ARRAY == o.type && o.via.array.size >= size)
+			fields = o.via.array.ptr;
+	}
+
+	const msgpack::object &Field(unsigned i) const { return fields[i]; }
+
+	template <typename T> T Copy() const { return oh.get().as<T>(); }
+
+	msgpack::object_handle oh;
+	const msgpack::object *fields = nullptr;
+};
+
+// walks a packed list of tuples, Item is constructed from each tuple as it is reached
+template <typename Item> class CTupleRange
+{
+public:
+	class iterator
+	{
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = Item;
+		using difference_type = std::ptrdiff_t;
+		using pointer = void;
+		using reference = Item;
+
+		explicit iterator(const msgpack::object *p) : p(p) {}
+		Item operator*() const { return Item(*p); }
+		iterator &operator++() { p++; return *this; }
+		iterator operator++(int) { auto i = *this; p++; return i; }
+		bool operator==(const iterator &other) const { return p == other.p; }
+		bool operator!=(const iterator &other) const { return p != other.p; }
+	private:
+		const msgpack::object *p;
+	};
+
+	CTupleRange() = default;
+	explicit CTupleRange(const msgpack::object &o)
+	{
+		if (msgpack::type::ARRAY == o.type)
+		{
+			first = o.via.array.ptr;
+			count = o.via.array.size;
+		}
+	}
+
+	iterator begin() const { return iterator(first); }
+	iterator end() const { return iterator(first + count); }
+	uint32_t size() const { return count; }
+	bool empty() const { return 0 == count; }
+
+private:
+	const msgpack::object *first = nullptr;
+	uint32_t count = 0;
+};
+
+// one item of a tuple list, a short or malformed tuple has empty fields
+class CTupleView
+{
+protected:
+	explicit CTupleView(const msgpack::object &o)
+	{
+		if (msgpack::type::ARRAY == o.type)
+		{
+			item = o.via.array.ptr;
+			size = o.via.array.size;
+		}
+	}
+	std::string_view Str(uint32_t i) const { return (i < size) ? CValueView::Str(item[i]) : std::string_view(); }
+	int64_t Int(uint32_t i) const { return (i < size) ? CValueView::Int(item[i]) : 0; }
+
+	const msgpack::object *item = nullptr;
+	uint32_t size = 0;
+};
+
+// a timestamp and sequence, with the same newest-wins rule as IsNewer() in dht-registry.h
+template <typename V> bool IsNewerView(const V &a, const V &b)
+{
+	if (a.Timestamp() != b.Timestamp())
+		return a.Timestamp() > b.Timestamp();
+	return a.Sequence() > b.Sequence();
+}
+
+// the parts with a timestamp, a sequence and a list of tuples
+template <typename Item, typename Owner> class CListView : public CValueView
+{
+public:
+	CListView() = default;
+	CListView(const dht::Value &v, const char *user_type) { Unpack(v, user_type, 3); }
+
+	std::time_t Timestamp() const { return Int(Field(0)); }
+	unsigned Sequence() const { return Int(Field(1)); }
+	CTupleRange<Item> List() const { return CTupleRange<Item>(Field(2)); }
+
+	Owner Copy() const { return CValueView::Copy<Owner>(); }
+};
+
+#ifdef USE_MREFD_VALUES
+
+class CMrefdConfig1View : public CValueView
+{
+public:
+	CMrefdConfig1View() = default;
+	explicit CMrefdConfig1View(const dht::Value &v) { Unpack(v, MREFD_CONFIG_1, 12); }
+
+	std::time_t      Timestamp()     const { return Int(Field(0)); }
+	unsigned         Sequence()      const { return 0; }
+	std::string_view Callsign()      const { return Str(Field(1)); }
+	std::string_view Ipv4addr()      const { return Str(Field(2)); }
+	std::string_view Ipv6addr()      const { return Str(Field(3)); }
+	std::string_view Modules()       const { return Str(Field(4)); }
+	std::string_view Encryptedmods() const { return Str(Field(5)); }
+	std::string_view Url()           const { return Str(Field(6)); }
+	std::string_view Email()         const { return Str(Field(7)); }
+	std::string_view Sponsor()       const { return Str(Field(8)); }
+	std::string_view Country()       const { return Str(Field(9)); }
+	std::string_view Version()       const { return Str(Field(10)); }
+	uint16_t         Port()          const { return Int(Field(11)); }
+
+	SMrefdConfig1 Copy() const { return CValueView::Copy<SMrefdConfig1>(); }
+};
+
+class CMrefdPeerView : public CTupleView
+{
+public:
+	explicit CMrefdPeerView(const msgpack::object &o) : CTupleView(o) {}
+	std::string_view Callsign()    const { return Str(toUType(EMrefdPeerFields::Callsign)); }
+	std::string_view Modules()     const { return Str(toUType(EMrefdPeerFields::Modules)); }
+	std::time_t      ConnectTime() const { return Int(toUType(EMrefdPeerFields::ConnectTime)); }
+};
+
+class CMrefdClientView : public CTupleView
+{
+public:
+	explicit CMrefdClientView(const msgpack::object &o) : CTupleView(o) {}
+	std::string_view Callsign()      const { return Str(toUType(EMrefdClientFields::Callsign)); }
+	std::string_view Ip()            const { return Str(toUType(EMrefdClientFields::Ip)); }
+	char             Module()        const { return char(Int(toUType(EMrefdClientFields::Module))); }
+	std::time_t      ConnectTime()   const { return Int(toUType(EMrefdClientFields::ConnectTime)); }
+	std::time_t      LastHeardTime() const { return Int(toUType(EMrefdClientFields::LastHeardTime)); }
+};
+
+class CMrefdUserView : public CTupleView
+{
+public:
+	explicit CMrefdUserView(const msgpack::object &o) : CTupleView(o) {}
+	std::string_view Source()        const { return Str(toUType(EMrefdUserFields::Source)); }
+	std::string_view Destination()   const { return Str(toUType(EMrefdUserFields::Destination)); }
+	std::string_view Reflector()     const { return Str(toUType(EMrefdUserFields::Reflector)); }
+	std::time_t      LastHeardTime() const { return Int(toUType(EMrefdUserFields::LastHeardTime)); }
+};
+
+class CMrefdPeers1View : public CListView<CMrefdPeerView, SMrefdPeers1>
+{
+public:
+	CMrefdPeers1View() = default;
+	explicit CMrefdPeers1View(const dht::Value &v) : CListView(v, MREFD_PEERS_1) {}
+};
+
+class CMrefdClients1View : public CListView<CMrefdClientView, SMrefdClients1>
+{
+public:
+	CMrefdClients1View() = default;
+	explicit CMrefdClients1View(const dht::Value &v) : CListView(v, MREFD_CLIENTS_1) {}
+};
+
+class CMrefdUsers1View : public CListView<CMrefdUserView, SMrefdUsers1>
+{
+public:
+	CMrefdUsers1View() = default;
+	explicit CMrefdUsers1View(const dht::Value &v) : CListView(v, MREFD_USERS_1) {}
+};
+
+#endif	// USE_MREFD_VALUES
+
+#ifdef USE_URFD_VALUES
+
+class CUrfdConfig1View : public CValueView
+{
+public:
+	CUrfdConfig1View() = default;
+	explicit CUrfdConfig1View(const dht::Value &v) { Unpack(v, URFD_CONFIG_1, 17); }
+
+	std::time_t      Timestamp()      const { return Int(Field(0)); }
+	unsigned         Sequence()       const { return 0; }
+	std::string_view Callsign()       const { return Str(Field(1)); }
+	std::string_view Ipv4addr()       const { return Str(Field(2)); }
+	std::string_view Ipv6addr()       const { return Str(Field(3)); }
+	std::string_view Modules()        const { return Str(Field(4)); }
+	std::string_view Transcodedmods() const { return Str(Field(5)); }
+	std::string_view Url()            const { return Str(Field(6)); }
+	std::string_view Email()          const { return Str(Field(7)); }
+	std::string_view Sponsor()        const { return Str(Field(8)); }
+	std::string_view Country()        const { return Str(Field(9)); }
+	std::string_view Version()        const { return Str(Field(10)); }
+	char             Almod(EUrfdAlMod m)       const { return char(Element(11, toUType(m))); }
+	unsigned long    Ysffreq(EUrfdTxRx t)      const { return Element(12, toUType(t)); }
+	unsigned         Refid(EUrfdRefId r)       const { return Element(13, toUType(r)); }
+	bool             G3enabled()               const { return Bool(Field(14)); }
+	uint16_t         Port(EUrfdPorts p)        const { return Element(15, toUType(p)); }
+
+	// the description of a module, or an empty view if there isn't one
+	std::string_view Description(char module) const
+	{
+		const auto &o = Field(16);
+		if (msgpack::type::MAP == o.type)
+		{
+			for (uint32_t i=0; i<o.via.map.size; i++)
+			{
+				if (Int(o.via.map.ptr[i].key) == module)
+					return Str(o.via.map.ptr[i].val);
+			}
+		}
+		return std::string_view();
+	}
+
+	SUrfdConfig1 Copy() const { return CValueView::Copy<SUrfdConfig1>(); }
+
+private:
+	// an element of one of the std::array fields
+	int64_t Element(unsigned field, unsigned i) const
+	{
+		const auto &o = Field(field);
+		if (msgpack::type::ARRAY == o.type && i < o.via.array.size)
+			return Int(o.via.array.ptr[i]);
+		return 0;
+	}
+};
+
+class CUrfdPeerView : public CTupleView
+{
+public:
+	explicit CUrfdPeerView(const msgpack::object &o) : CTupleView(o) {}
+	std::string_view Callsign()    const { return Str(toUType(EUrfdPeerFields::Callsign)); }
+	std::string_view Modules()     const { return Str(toUType(EUrfdPeerFields::Modules)); }
+	std::time_t      ConnectTime() const { return Int(toUType(EUrfdPeerFields::ConnectTime)); }
+};
+
+class CUrfdPeers1View : public CListView<CUrfdPeerView, SUrfdPeers1>
+{
+public:
+	CUrfdPeers1View() = default;
+	explicit CUrfdPeers1View(const dht::Value &v) : CListView(v, URFD_PEERS_1) {}
+};
+
+#endif	// USE_URFD_VALUES
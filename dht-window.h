@@ -0,0 +1,128 @@
+/*
+ *   Copyright (c) 2026 by Thomas A. Early N7TAE
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#pragma once
+
+#include <list>
+#include <mutex>
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <condition_variable>
+
+// limits the number of node.get()s in flight and abandons any get that outlives its deadline
+// Acquire() a ticket before each get and hand the result to Finish() from the done callback
+class CLookupWindow
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	struct STicket
+	{
+		Clock::time_point deadline;
+		std::atomic<bool> expired { false }; // a value callback can return !expired to stop the search
+		std::function<void()> onexpire;      // called without the window lock when the deadline passes
+	};
+
+	// a zero timeout means a lookup is never abandoned
+	CLookupWindow(unsigned size, std::chrono::milliseconds timeout) : size(size ? size : 1), timeout(timeout) {}
+
+	// blocks until there is room for another lookup
+	// deadlines are only checked while Acquire() or WaitAll() is waiting
+	std::shared_ptr<STicket> Acquire(std::function<void()> onexpire = nullptr)
+	{
+		std::unique_lock<std::mutex> lck(mtx);
+		while (active.size() >= size)
+			Wait(lck);
+		auto ticket = std::make_shared<STicket>();
+		ticket->deadline = Clock::now() + timeout;
+		ticket->onexpire = std::move(onexpire);
+		active.push_back(ticket);
+		return ticket;
+	}
+
+	// commit runs under the window lock, and only if the lookup hasn't been abandoned
+	// returns false if the lookup was abandoned
+	bool Finish(const std::shared_ptr<STicket> &ticket, const std::function<void()> &commit)
+	{
+		std::lock_guard<std::mutex> lck(mtx);
+		if (ticket->expired)
+			return false;
+		if (commit)
+			commit();
+		active.remove(ticket);
+		cv.notify_all();
+		return true;
+	}
+
+	// blocks until every lookup has finished or been abandoned
+	void WaitAll()
+	{
+		std::unique_lock<std::mutex> lck(mtx);
+		while (! active.empty())
+			Wait(lck);
+	}
+
+	unsigned Abandoned() const { return abandoned; }
+
+private:
+	// wait for a lookup to finish, or for the oldest lookup to pass its deadline
+	void Wait(std::unique_lock<std::mutex> &lck)
+	{
+		if (timeout.count() <= 0)
+		{
+			cv.wait(lck);
+			return;
+		}
+		const auto oldest = active.front()->deadline;
+		if (std::cv_status::timeout == cv.wait_until(lck, oldest))
+		{
+			const auto now = Clock::now();
+			std::list<std::function<void()>> hooks;
+			for (auto it=active.begin(); it!=active.end(); )
+			{
+				if ((*it)->deadline <= now)
+				{
+					(*it)->expired = true;
+					abandoned++;
+					if ((*it)->onexpire)
+						hooks.push_back(std::move((*it)->onexpire));
+					it = active.erase(it);
+				}
+				else
+					it++;
+			}
+			// every caller rechecks its condition after Wait(), so the lock can be let go here
+			if (! hooks.empty())
+			{
+				lck.unlock();
+				for (auto &hook : hooks)
+					hook();
+				lck.lock();
+			}
+		}
+	}
+
+	const unsigned size;
+	const std::chrono::milliseconds timeout;
+	std::mutex mtx;
+	std::condition_variable cv;
+	std::list<std::shared_ptr<STicket>> active; // in deadline order, since every lookup has the same timeout
+	unsigned abandoned = 0;
+};
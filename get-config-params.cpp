@@ -0,0 +1,289 @@
+/*
+ *   Copyright (c) 2026 by Thomas A. Early N7TAE
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <opendht.h>
+#include <getopt.h>
+#include <iostream>
+#include <string>
+#include <map>
+#include <mutex>
+#include <condition_variable>
+
+#include "dht-values.h"
+#include "dht-views.h"
+#include "dht-crawl.h"
+#include "dht-node.h"
+
+static const std::string default_bs("xlx757.openquad.net");
+static const unsigned default_window = 8;
+static const unsigned default_retries = 3;
+
+// the newest Config value received for one reflector
+// only one field is printed, so the values are kept packed and read through a view
+struct SConfigResult
+{
+	std::shared_ptr<dht::Value> mrefdValue, urfdValue; // the views point into these
+	CMrefdConfig1View mrefd;
+	CUrfdConfig1View  urfd;
+};
+
+static std::mutex mtx;
+static std::condition_variable cv;
+static unsigned pending = 0;
+static std::map<std::string, std::shared_ptr<SConfigResult>> configs;
+
+static void Explain(std::ostream &ostr)
+{
+	ostr << "c (for Country)" << std::endl;
+	ostr << "e (for Email)" << std::endl;
+	ostr << "p (for Port)" << std::endl;
+	ostr << "s (for Sponsor)" << std::endl;
+	ostr << "u (for URL)" << std::endl;
+	ostr << "v (for Version)" << std::endl;
+	ostr << "4 (for IPv4Address)" << std::endl;
+	ostr << "6 (for IPv6Address)" << std::endl;
+}
+
+static void Usage(std::ostream &ostr, const char *comname)
+{
+	ostr << "Usage: " << comname << " [-b bootstrap] [-j gets] [-r tries] [--identity dir | --ephemeral] [--gateway url] reflector module (c|e|p|s|u|v|4|6)" << std::endl;
+	Explain(ostr);
+	ostr << "Options:" << std::endl;
+	ostr << "    -b (bootstrap) argument is any running node on the dht network, or a comma separated" << std::endl;
+	ostr << "       list of them, which are all tried at the same time." << std::endl;
+	ostr << "       If not specified, " << default_bs << " will be used." << std::endl;
+	ostr << "    -j the maximum number of peer lookups in flight, default is " << default_window << std::endl;
+	ostr << "    -r the most times a reflector that wasn't found is looked up again, default is " << default_retries << std::endl;
+	NodeUsage(ostr);
+}
+
+static void Get(dht::DhtRunner &node, CVerifier &verifier, CRetrier &retrier, const std::shared_ptr<SConfigResult> &result, const std::string &refcs, const dht::Where &w, unsigned attempt)
+{
+	node.get(
+		dht::InfoHash::get(refcs),
+		[&verifier, result](const std::shared_ptr<dht::Value> &v)
+		{
+			verifier.Check(v, [result](const std::shared_ptr<dht::Value> &v)
+			{
+				if (0 == v->user_type.compare(MREFD_CONFIG_1))
+				{
+					CMrefdConfig1View view(*v);
+					if (view.IsValid() && (! result->mrefd.IsValid() || IsNewerView(view, result->mrefd)))
+					{
+						result->mrefd = std::move(view);
+						result->mrefdValue = v;
+					}
+				}
+				else if (0 == v->user_type.compare(URFD_CONFIG_1))
+				{
+					CUrfdConfig1View view(*v);
+					if (view.IsValid() && (! result->urfd.IsValid() || IsNewerView(view, result->urfd)))
+					{
+						result->urfd = std::move(view);
+						result->urfdValue = v;
+					}
+				}
+			});
+			return true;
+		},
+		[&node, &verifier, &retrier, result, refcs, &w, attempt](bool success)
+		{
+			verifier.Then([&node, &verifier, &retrier, result, refcs, &w, attempt, success]()
+			{
+				// still pending while it waits to be retried
+				const bool found = result->mrefd.IsValid() || result->urfd.IsValid();
+				if (! found && retrier.Retry(attempt, [&node, &verifier, &retrier, result, refcs, &w, attempt]() { Get(node, verifier, retrier, result, refcs, w, attempt + 1); }))
+					return;
+				if (! success)
+					std::cerr << "get() failed!" << std::endl;
+				std::lock_guard<std::mutex> lck(mtx);
+				pending--;
+				cv.notify_all();
+			});
+		},
+		{}, // empty filter
+		w
+	);
+}
+
+// start getting the Config of a reflector, this doesn't block
+static void GetConfig(dht::DhtRunner &node, CVerifier &verifier, CRetrier &retrier, const std::string &refcs, const dht::Where &w)
+{
+	auto result = std::make_shared<SConfigResult>();
+	{
+		std::lock_guard<std::mutex> lck(mtx);
+		configs[refcs] = result;
+		pending++;
+	}
+	Get(node, verifier, retrier, result, refcs, w, 0);
+}
+
+// the selected parameter from the view of a Config, mrefd and urfd only differ in their port
+template <typename V> static std::string Param(const V &c, const char k, uint16_t port)
+{
+	switch (k)
+	{
+		case 'c': return std::string(c.Country());
+		case 'e': return std::string(c.Email());
+		case 'p': return std::to_string(port);
+		case 's': return std::string(c.Sponsor());
+		case 'u': return std::string(c.Url());
+		case 'v': return std::string(c.Version());
+		case '4': return std::string(c.Ipv4addr());
+		case '6': return std::string(c.Ipv6addr());
+	}
+	return "null";
+}
+
+// the selected parameter, or null if the reflector didn't publish a Config
+static std::string Param(const SConfigResult &cfg, const char k)
+{
+	if (cfg.mrefd.IsValid() && cfg.mrefd.Timestamp())
+		return Param(cfg.mrefd, k, cfg.mrefd.Port());
+	else if (cfg.urfd.IsValid() && cfg.urfd.Timestamp())
+		return Param(cfg.urfd, k, cfg.urfd.Port(EUrfdPorts::m17));
+	return "null";
+}
+
+int main(int argc, char *argv[])
+{
+	std::string bs(default_bs);
+	unsigned window = default_window;
+	unsigned tries = default_retries;
+	SNodeOptions nodeopts;
+	static const struct option long_options[] = {
+		{ "identity",  required_argument, nullptr, OPT_IDENTITY  },
+		{ "ephemeral", no_argument,       nullptr, OPT_EPHEMERAL },
+		{ "gateway",   required_argument, nullptr, OPT_GATEWAY   },
+		{ "ready-nodes", required_argument, nullptr, OPT_READYNODES },
+		{ "ready-wait",  required_argument, nullptr, OPT_READYWAIT  },
+		{ nullptr, 0, nullptr, 0 }
+	};
+	while (1)
+	{
+		int c = getopt_long(argc, argv, "b:j:r:", long_options, nullptr);
+		if (c < 0)
+			break;
+
+		switch (c)
+		{
+		case 'b':
+			bs.assign(optarg);
+			break;
+		case 'r':
+			tries = std::strtoul(optarg, nullptr, 10);
+			break;
+		case 'j':
+			window = std::strtoul(optarg, nullptr, 10);
+			if (0 == window)
+			{
+				std::cerr << "Error: -j must be at least 1!" << std::endl;
+				Usage(std::cerr, argv[0]);
+				exit(EXIT_FAILURE);
+			}
+			break;
+		case OPT_IDENTITY:
+			nodeopts.statedir.assign(optarg);
+			break;
+		case OPT_EPHEMERAL:
+			nodeopts.ephemeral = true;
+			break;
+		case OPT_GATEWAY:
+			nodeopts.gateway.assign(optarg);
+			break;
+		case OPT_READYNODES:
+			nodeopts.readynodes = std::strtoul(optarg, nullptr, 10);
+			break;
+		case OPT_READYWAIT:
+			nodeopts.readywait = std::strtod(optarg, nullptr);
+			break;
+		default:
+			Usage(std::cerr, argv[0]);
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	if (optind + 3 != argc)
+	{
+		Usage(std::cerr, argv[0]);
+		exit(EXIT_FAILURE);
+	}
+
+	std::string key(argv[optind]);
+	for (auto &c : key)
+		c = std::toupper(c);
+	const auto isM17 = 0 == key.compare(0, 4, "M17-");
+
+	const std::string mod(argv[optind+1]);
+	if (1 != mod.size() || ! std::isalpha(mod[0]))
+	{
+		std::cerr << "Error: second argument must specify a single module!" << std::endl;
+		Usage(std::cerr, argv[0]);
+		exit(EXIT_FAILURE);
+	}
+	const char module = std::toupper(mod[0]);
+
+	const char k = std::tolower(argv[optind+2][0]);
+	if (std::string::npos == std::string("cepsuv46").find(k))
+	{
+		std::cerr << "'" << argv[optind+2] << "' is not regcognized! Please use one of:" << std::endl;
+		Explain(std::cerr);
+		exit(2);
+	}
+
+	CRetrier retrier(tries);
+	CVerifier verifier;	// declared first, so it outlives the node's callbacks
+	dht::DhtRunner node;
+	try {
+		RunNode(node, "GetConfigParams", bs, nodeopts);
+		verifier.Load(nodeopts.statedir);
+	} catch (const std::exception &ex) {
+		std::cout << argv[0] << " can't connect to the Ham-DHT! " << ex.what() << std::endl;
+		return 1;
+	}
+
+	// the Config of each reflector is requested as soon as the crawl finds it
+	dht::Where w;
+	w.id(isM17 ? toUType(EMrefdValueID::Config) : toUType(EUrfdValueID::Config));
+	CCrawler crawler(node, verifier, module, isM17, window);
+	crawler.OnFound([&node, &verifier, &retrier, &w](const std::string &refcs) { GetConfig(node, verifier, retrier, refcs, w); });
+	crawler.Retry(retrier);
+	crawler.Run(key);
+
+	{
+		std::unique_lock<std::mutex> lck(mtx);
+		while (pending)
+			cv.wait(lck);
+	}
+	retrier.Stop();
+	if (retrier.Retries())
+		std::cerr << retrier.Retries() << " lookup(s) were retried" << std::endl;
+
+	// the web is ordered by callsign, just like 'dht-spider -l'
+	for (const auto &item : crawler.GetWeb())
+	{
+		std::cout << item.first << ' ' << Param(*configs[item.first], k) << '\n';
+	}
+	std::cout.flush();
+
+	verifier.Save();
+	SaveNodes(node, nodeopts);
+	node.join();
+
+	return EXIT_SUCCESS;
+}
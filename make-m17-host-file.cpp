@@ -17,199 +17,627 @@
  */
 
 #include <nlohmann/json.hpp>
-#include <curl/curl.h>
 #include <opendht.h>
+#include <getopt.h>
 #include <iostream>
+#include <fstream>
+#include <deque>
+#include <thread>
 #include <sstream>
-#include <string>
+#include <iomanip>
+#include <map>
+#include <memory>
 #include <mutex>
+#include <future>
+#include <csignal>
+#include <functional>
+#include <string>
+#include <vector>
 #include <algorithm>
-#include <condition_variable>
+#include <atomic>
+#include <ctime>
+#include <cstdio>
+#include <unistd.h>
 
 #include "dht-values.h"
 #include "dht-helpers.h"
+#include "dht-registry.h"
+#include "dht-retry.h"
+#include "dht-stats.h"
+#include "dht-window.h"
+#include "dht-verify.h"
+#include "dht-node.h"
+#include "dht-hostcache.h"
+#include "dht-pipe.h"
+#include "dht-fetch.h"
+#include "dht-hostdb.h"
+#include "dht-file.h"
 
 static const std::string Version("1.4.1");
 std::string hostname("xrf757.openquad.net");
 std::string target;
-static bool got_data;
-static bool running;
-static std::condition_variable cv;
-static std::mutex mtx;
 static char section = 'a';
 static bool use_local = false;
 static dht::Where w;
-static SMrefdConfig1  mrefdConfig;
-static SUrfdConfig1   urfdConfig;
+static const unsigned default_window = 16;
+static const unsigned default_timeout = 20;
+static const unsigned default_retries = 3;
+static const long default_refresh = 6 * 3600;
+static const long default_maxage = 24 * 3600;
+static const long default_interval = 3600;
+static const long default_debounce = 10;
+static const long save_interval = 600;
+
+enum { OPT_REFRESH = 0x200, OPT_MAXAGE, OPT_HOSTDB, OPT_DAEMON, OPT_INTERVAL, OPT_DEBOUNCE };
 
+// the Configs found by earlier runs
+static CHostCache cache;
+static std::time_t now;
+static long refresh = default_refresh; // a cached Config older than this is always looked up in full
+static long maxage = default_maxage;   // a cached Config younger than this is used when a lookup fails
+static std::atomic<unsigned> unchanged { 0 }, fallbacks { 0 };
+
+static std::string output; // the host file, or stdout if empty
+static std::string hostdb; // the binary host database, or none if empty
+static bool follow = false; // --daemon
+static long interval = default_interval; // how often a daemon fetches the json file again
+static long debounce = default_debounce; // how long a daemon waits for the Configs to stop changing
+
+enum class ESource { dvref, dht };
 
-// callback function writes data to a std::ostream
-static size_t data_write(void  *buf, size_t size, size_t nmemb, void *userp)
+// one line of the host file, in the same order as the reflectors in the json file
+struct SHostRow
 {
-	if(userp)
-	{
-		std::ostream &os = *static_cast<std::ostream *>(userp);
-		std::streamsize len = size * nmemb;
-		if(os.write(static_cast<char*>(buf), len))
-			return len;
-	}
+	std::string cs, version, mods, smods, ipv4, ipv6, url;
+	uint16_t port = 17000;
+	ESource src = ESource::dvref;
+	bool unknown = false;      // neither an M17 nor a URF reflector
+	bool unsuccessful = false; // the get() reported a failure
+};
 
-	return 0;
-}
+// what a single node.get() has received so far, and the seq of the value the newest Config came in
+struct SLookup : public CValueSet<SMrefdConfig1, SUrfdConfig1>
+{
+	uint16_t seq = 0;
+};
+
+std::string comname;
+
+using json = nlohmann::json;
+#define GET_STRING(a) ((a).is_string() ? a : "")
 
-/**
- * timeout is in seconds
- **/
-static CURLcode curl_read(const std::string& url, std::ostream& os, long timeout = 30)
+// Picks the reflectors out of the json file while it is still being read.
+// Only the reflector being parsed is built as a json value, and it is handed to 'found'
+// as soon as its closing brace is read, so the whole file is never held in memory.
+class CReflectorSax : public nlohmann::json_sax<json>
 {
-	CURLcode code(CURLE_FAILED_INIT);
-	CURL* curl = curl_easy_init();
-	const std::string agent(std::string("Ham-DHT/")+Version);
-
-	if(curl)
-	{
-		if(CURLE_OK == (code = curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, &data_write))
-		&& CURLE_OK == (code = curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 1L))
-		&& CURLE_OK == (code = curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L))
-		&& CURLE_OK == (code = curl_easy_setopt(curl, CURLOPT_FILE, &os))
-		&& CURLE_OK == (code = curl_easy_setopt(curl, CURLOPT_TIMEOUT, timeout))
-		&& CURLE_OK == (code = curl_easy_setopt(curl, CURLOPT_USERAGENT, agent.c_str()))
-		&& CURLE_OK == (code = curl_easy_setopt(curl, CURLOPT_URL, url.c_str())))
+public:
+	CReflectorSax(std::function<void(json &)> f) : found(std::move(f)) {}
+
+	bool null() override { return Value(nullptr); }
+	bool boolean(bool b) override { return Value(b); }
+	bool number_integer(number_integer_t i) override { return Value(i); }
+	bool number_unsigned(number_unsigned_t u) override { return Value(u); }
+	bool number_float(number_float_t f, const string_t &) override { return Value(f); }
+	bool string(string_t &s) override { return Value(std::move(s)); }
+	bool binary(binary_t &b) override { return Value(json::binary(std::move(b))); }
+
+	bool start_object(std::size_t) override { return Open(json::object()); }
+	bool start_array(std::size_t) override
+	{
+		// the reflectors array is the "reflectors" member of the top level object
+		if (1 == depth && 0 == lastkey.compare("reflectors"))
 		{
-			code = curl_easy_perform(curl);
+			inreflectors = sawreflectors = true;
+			depth++;
+			return true;
 		}
-		curl_easy_cleanup(curl);
+		return Open(json::array());
+	}
+	bool key(string_t &k) override
+	{
+		lastkey = k;
+		if (! open.empty())
+			slot = &(*open.back())[k];
+		return true;
+	}
+	bool end_object() override { return Close(); }
+	bool end_array() override
+	{
+		if (inreflectors && 2 == depth)
+		{
+			inreflectors = false;
+			depth--;
+			return true;
+		}
+		return Close();
 	}
-	return code;
-}
 
-static bool ReadM17Json(const std::string &url, std::stringstream &ss)
-{
-	curl_global_init(CURL_GLOBAL_ALL);
+	bool parse_error(std::size_t, const std::string &, const nlohmann::detail::exception &ex) override
+	{
+		error.assign(ex.what());
+		return false;
+	}
+
+	bool SawReflectors() const { return sawreflectors; }
+	const std::string &Error() const { return error; }
 
-	if(CURLE_OK == curl_read(url, ss)) {
-		std::cout << "# Copied " << url << std::endl;
-	} else {
-		std::cout << "# ERROR: Could not copy " << url << std::endl;
+private:
+	// a value is only kept when it is inside a reflector
+	template <typename T> bool Value(T &&v)
+	{
+		if (! open.empty())
+		{
+			if (open.back()->is_array())
+				open.back()->emplace_back(std::forward<T>(v));
+			else
+				*slot = std::forward<T>(v);
+		}
+		return true;
+	}
+	bool Open(json &&j)
+	{
+		depth++;
+		if (inreflectors && 3 == depth)
+		{
+			// a new reflector
+			current = std::move(j);
+			open.assign(1, &current);
+		}
+		else if (! open.empty())
+		{
+			// only the last element of an array is ever open, so pushing it can't move an open one
+			json *child = slot;
+			if (open.back()->is_array())
+			{
+				open.back()->emplace_back(std::move(j));
+				child = &open.back()->back();
+			}
+			else
+				*child = std::move(j);
+			open.push_back(child);
+		}
+		return true;
+	}
+	bool Close()
+	{
+		if (! open.empty())
+		{
+			open.pop_back();
+			if (open.empty())
+			{
+				found(current);
+				current = json();
+			}
+		}
+		depth--;
 		return true;
 	}
 
-	curl_global_cleanup();
-	return false;
-}
+	std::function<void(json &)> found;
+	json current;              // the reflector being parsed
+	std::vector<json *> open;  // the objects and arrays of the current reflector that are still open
+	json *slot = nullptr;      // where the value of the last key goes
+	std::string lastkey;
+	std::string error;
+	unsigned depth = 0;
+	bool inreflectors = false, sawreflectors = false;
+};
 
-std::string comname;
+// the mirrors in a comma separated list of urls
+static std::vector<std::string> Split(const std::string &list)
+{
+	std::vector<std::string> urls;
+	std::string::size_type pos = 0;
+	while (pos <= list.size())
+	{
+		auto comma = list.find(',', pos);
+		if (std::string::npos == comma)
+			comma = list.size();
+		if (comma > pos)
+			urls.emplace_back(list.substr(pos, comma - pos));
+		pos = comma + 1;
+	}
+	return urls;
+}
 
-using json = nlohmann::json;
-#define GET_STRING(a) ((a).is_string() ? a : "")
+// read a local file through the same sink as a download
+static bool ReadFile(const std::string &path, const CFetcher::Sink &sink)
+{
+	std::ifstream ifile(path, std::ios::binary);
+	if (! ifile.is_open())
+		return false;
+	char buf[65536];
+	while (ifile.read(buf, sizeof(buf)).gcount())
+	{
+		if (! sink(buf, ifile.gcount()))
+			break;
+	}
+	return true;
+}
 
 static void Usage(std::ostream &ostr)
 {
 	ostr
-	<< std::endl << "Usage: " << comname << " [target  [hostname]]\n\n"
+	<< std::endl << "Usage: " << comname << " [-j lookups] [-t seconds] [-r tries] [-o file] [--daemon [--interval secs] [--debounce secs]] [--refresh secs] [--max-age secs] [--hostdb file] [--stats] [--identity dir | --ephemeral] [--gateway url] [target  [hostname]]\n\n"
 	<< "Ther can be zero, one or two parameters"
 	<< "The first parameter:\n"
 	<< "target\n"
 	<< "    This could be either a pathname to a M17Hosts.json file, or\n"
 	<< "    a url where the file can be obtained with the curl library.\n"
+	<< "    A comma separated list of mirror urls are all tried at the same time,\n"
+	<< "    and the first one to answer is used.\n"
 	<< "The optional second paramater:\n"
 	<< "hostname\n"
-	<< "    Where 'hostname' is any running node on the Ham-DHT network\n"
+	<< "    Where 'hostname' is any running node on the Ham-DHT network, or a comma\n"
+	<< "    separated list of them, which are all tried at the same time.\n"
 	<< "    If not specified, " << hostname << " will be used.\n"
+	<< "Options:\n"
+	<< "-j  The maximum number of Ham-DHT lookups in flight, default is " << default_window << ".\n"
+	<< "-t  The number of seconds to wait for a lookup before giving up on it,\n"
+	<< "    default is " << default_timeout << ". Zero means wait forever.\n"
+	<< "-r  The most times a reflector that wasn't found is looked up again, default is " << default_retries << ".\n"
+	<< "    The retries count against the -t time.\n"
+	<< "-o  Write the host file here, through a temporary file that is renamed, instead of to stdout.\n"
+	<< "--daemon\n"
+	<< "    Keep running after the host file is written, listen to every reflector's Config,\n"
+	<< "    and write the host file again whenever one of its rows changes. Needs -o.\n"
+	<< "--interval secs\n"
+	<< "    How often a daemon fetches the json file again, default is " << default_interval << ". Zero never does.\n"
+	<< "--debounce secs\n"
+	<< "    A daemon waits until no Config has changed for this long before it writes,\n"
+	<< "    default is " << default_debounce << ", but never more than ten times as long.\n"
+	<< "--stats\n"
+	<< "    Output where the time went, and what happened to the values, as json on stderr.\n"
+	<< "--identity dir\n"
+	<< "    Where the node identity is saved, default is " << DefaultStateDir() << ".\n"
+	<< "--ephemeral\n"
+	<< "    Use a new identity that isn't saved.\n"
+	<< "--gateway url\n"
+	<< "    Use a running dht-gateway, like http://127.0.0.1:8000, instead of starting a node.\n"
+	<< "--ready-nodes n\n"
+	<< "    How many good nodes the routing table needs before the lookups start, default is 4.\n"
+	<< "--ready-wait secs\n"
+	<< "    The most time to wait for them, default is 5.\n"
+	<< "--refresh secs\n"
+	<< "    A reflector whose cached Config was verified by a full lookup within this time only\n"
+	<< "    has the seq of its Config checked, default is " << default_refresh << ". Zero always looks up every Config in full.\n"
+	<< "--max-age secs\n"
+	<< "    When a lookup fails, a cached Config that was verified within this time is used instead,\n"
+	<< "    default is " << default_maxage << ". Zero never uses the cache for a failed lookup.\n"
+	<< "--hostdb file\n"
+	<< "    Also write the host file as a binary database, that dht-hostdb.h can look a\n"
+	<< "    reflector up in without parsing anything.\n"
 	<< "If no parameters are supplied, a usage message will be printed.\n"
 	<< std::endl;
 }
 
-enum class ESource { dvref, dht };
-int main (int argc, char *argv[])
+// copy what the reflector published into its row
+static void Apply(const SLookup &result, SHostRow &row)
 {
-	comname.assign(argv[0]);
-	switch (argc)
+	if (result.Has<SMrefdConfig1>() && 0 == row.cs.substr(0,4).compare("M17-"))
 	{
-		case 1:
-			Usage(std::cout);
-			return EXIT_SUCCESS;
-		case 2:
-			target.assign(argv[1]);
-			break;
-		case 3:
-			target.assign(argv[1]);
-			hostname.assign(argv[2]);
-			break;
-		default:
-			Usage(std::cerr);
-			return EXIT_FAILURE;
+		const auto &mrefdConfig = result.Get<SMrefdConfig1>();
+		row.version.assign(mrefdConfig.version);
+		if (mrefdConfig.ipv4addr.size())
+			row.ipv4.assign(mrefdConfig.ipv4addr);
+		if (mrefdConfig.ipv6addr.size())
+			row.ipv6.assign(mrefdConfig.ipv6addr);
+		if (mrefdConfig.modules.size())
+			row.mods.assign(mrefdConfig.modules);
+		if (mrefdConfig.encryptedmods.size())
+			row.smods.assign(mrefdConfig.encryptedmods);
+		if (mrefdConfig.url.size())
+			row.url.assign(mrefdConfig.url);
+		row.port = mrefdConfig.port;
+		row.src = ESource::dht;
 	}
-
-	// boot up the Ham-DTH
-	std::string name("GetM17Hosts");
-	name += std::to_string(getpid());
-	dht::DhtRunner node;
-	try {
-		node.run(17171, dht::crypto::generateIdentity(name), true, 59973);
-		node.bootstrap(hostname, "17171");
-	} catch (const std::exception &ex) {
-		std::cout << argv[0] << " can't connect to the Ham-DHT! " << ex.what() << std::endl;
-		return 1;
+	else if (result.Has<SUrfdConfig1>() && 0 == row.cs.substr(0,3).compare("URF"))
+	{
+		const auto &urfdConfig = result.Get<SUrfdConfig1>();
+		row.version.assign(urfdConfig.version);
+		if (urfdConfig.ipv4addr.size())
+			row.ipv4.assign(urfdConfig.ipv4addr);
+		if (urfdConfig.ipv6addr.size())
+			row.ipv6.assign(urfdConfig.ipv6addr);
+		if (urfdConfig.modules.size())
+			row.mods.assign(urfdConfig.modules);
+		if (urfdConfig.transcodedmods.size())
+			row.smods.assign(urfdConfig.transcodedmods);
+		row.port = urfdConfig.port[toUType(EUrfdPorts::m17)];
+		row.src = ESource::dht;
+		if (urfdConfig.url.size())
+			row.url.assign(urfdConfig.url);
 	}
+}
 
-	// print the preamble
-	auto t = std::time(nullptr);
-	auto tm = *std::gmtime(&t);
-	std::cout 
-	<< "# M17 Hosts file generated by " << comname << " V#" << Version << '\n'
-	<< "# Copyright (C) 2024-2026 by Thomas A. Early, N7TAE.\n"
-	<< "# See the LICENSE file in https://github.com/n7tae/dht-ham-tools.\n"
-	<< "# Created on " << std::put_time(&tm, "%Y-%m-%d at %H:%M GMT") << std::endl;
+// the row's Ham-DHT fields, as they go into the cache
+static SHostCacheEntry ToEntry(const SLookup &result, const SHostRow &row)
+{
+	SHostCacheEntry entry;
+	entry.designator = row.cs;
+	entry.version = row.version;
+	entry.mods = row.mods;
+	entry.smods = row.smods;
+	entry.ipv4 = row.ipv4;
+	entry.ipv6 = row.ipv6;
+	entry.url = row.url;
+	entry.port = row.port;
+	entry.timestamp = result.Has<SMrefdConfig1>() ? result.Get<SMrefdConfig1>().timestamp : result.Get<SUrfdConfig1>().timestamp;
+	entry.seq = result.seq;
+	entry.checked = now;
+	return entry;
+}
 
-	// downlaod and parse the mrefd and urf json file
-	std::stringstream ss;
-	if (std::string::npos != target.find(":/"))
+// copy a cached Config into its row, just like Apply()
+static void ApplyCached(const SHostCacheEntry &entry, SHostRow &row)
+{
+	row.version.assign(entry.version);
+	row.ipv4.assign(entry.ipv4);
+	row.ipv6.assign(entry.ipv6);
+	row.mods.assign(entry.mods);
+	row.smods.assign(entry.smods);
+	row.url.assign(entry.url);
+	row.port = entry.port;
+	row.src = ESource::dht;
+}
+
+// fill in what the json file says about a reflector
+static void MakeRow(json &ref, SHostRow &row)
+{
+	row.cs.assign(ref["designator"].get<std::string>());
+	row.ipv4.assign(GET_STRING(ref["ipv4"]));
+	row.ipv6.assign(GET_STRING(ref["ipv6"]));
+	row.url.assign(GET_STRING(ref["url"]));
+	if (0 == row.cs.substr(0,4).compare("M17-"))
 	{
-		if (ReadM17Json(target, ss))
-		{
-			std::cerr << "ERROR curling M17 reflectors from hostfiles.refcheck.radio/M17Hosts.json" << std::endl;
-			return EXIT_FAILURE;
+		if (ref.contains("modules")) {
+			for (auto &mod : ref["modules"])
+				row.mods.append(GET_STRING(mod));
+		}
+		if (row.mods.size() > 1)
+			std::sort(row.mods.begin(), row.mods.end());
+		if (ref.contains("encrypted")) {
+			for (auto &mod : ref["encrypted"])
+				row.smods.append(GET_STRING(mod));
 		}
-	} else {
-		std::ifstream ifile(target);
-		if (ifile.is_open())
+		if (row.smods.size() > 1)
+			std::sort(row.smods.begin(), row.smods.end());
+		if (ref.contains("port") and ref["port"].is_number_unsigned())
+			row.port = ref["port"].get<uint16_t>();
+	}
+	else if (0 == row.cs.substr(0,3).compare("URF"))
+	{
+		// fish out the modules and transcoded modules
+		if (ref.contains("modules"))
 		{
-			ss << ifile.rdbuf();
-		} else {
-			std::cerr << "ERROR: could not open " << target << std::endl;
-			return EXIT_FAILURE;
+			for (auto &mod : ref["modules"])
+			{
+				auto m = mod["module"].get<std::string>();
+				const std::string mode(GET_STRING(mod["mode"]));
+				if (0==mode.compare("All") or 0==mode.compare("M17"))
+				{
+					row.mods.append(m);
+					if (mod["transcode"].is_boolean())
+					{
+						if (mod["transcode"].get<bool>())
+							row.smods.append(m);
+					}
+					if (0 == mode.compare("M17"))
+					{
+						if (mod["port"].is_number_unsigned())
+							row.port = mod["port"].get<uint16_t>();
+					}
+				}
+			}
 		}
 	}
+	else
+	{
+		row.unknown = true;
+	}
+}
 
-	json mref;
+static void Get(dht::DhtRunner &node, CVerifier &verifier, CLookupWindow &window, CRetrier &retrier, const std::shared_ptr<CLookupWindow::STicket> &ticket, SHostRow &row, unsigned attempt)
+{
+	auto result = std::make_shared<SLookup>();
+	const auto sent = stats.Start();
+	node.get(
+		dht::InfoHash::get(row.cs),
+		[&verifier, ticket, result](const std::shared_ptr<dht::Value> &v) {
+			stats.Received();
+			verifier.Check(v, [result](const std::shared_ptr<dht::Value> &v) {
+				const auto start = stats.Start();
+				const auto a = result->Accept(*v);
+				stats.Accepted(a, start);
+				if (EAccept::newer == a)
+					result->seq = v->seq;
+			});
+			return ! ticket->expired; // an abandoned lookup stops the search
+		},
+		[&node, &verifier, &window, &retrier, ticket, result, &row, attempt, sent](bool success) {
+			stats.Latency(sent);
+			verifier.Then([&node, &verifier, &window, &retrier, ticket, result, &row, attempt, success]() {
+				// a reflector that wasn't found keeps its place in the window while it waits to be retried
+				const bool found = result->Has<SMrefdConfig1>() || result->Has<SUrfdConfig1>();
+				if (! found && ! ticket->expired && retrier.Retry(attempt, [&node, &verifier, &window, &retrier, ticket, &row, attempt]() { if (! ticket->expired) Get(node, verifier, window, retrier, ticket, row, attempt + 1); }))
+					return;
+				window.Finish(ticket, [&]() {
+					row.unsuccessful = ! success;
+					if (found)
+					{
+						Apply(*result, row);
+						cache.Store(ToEntry(*result, row));
+						return;
+					}
+					// a Config that was seen recently enough is better than none at all
+					SHostCacheEntry entry;
+					if (maxage > 0 && cache.Find(row.cs, entry) && now - entry.checked <= maxage)
+					{
+						ApplyCached(entry, row);
+						fallbacks++;
+					}
+				});
+			});
+		},
+		{},	// empty filter
+		w
+	);
+}
 
-	try {
-		mref = json::parse(ss.str());
-	}
-	catch (const std::exception &e) {
-		std::cerr << "ERROR: " << e.what() << std::endl;
-		std::cerr << target << "contains " << std::endl;
-		std::cerr << ss.str() << std::endl;
-		return EXIT_FAILURE;
+// a cached Config is still good if the Ham-DHT has a Config value with the same seq, and no other
+// only the seq of each value comes back from a query(), so nothing needs to be unpacked or verified
+static void CheckSeq(dht::DhtRunner &node, CVerifier &verifier, CLookupWindow &window, CRetrier &retrier, const std::shared_ptr<CLookupWindow::STicket> &ticket, SHostRow &row, const SHostCacheEntry &entry)
+{
+	// both flags are only touched on the node's thread
+	auto same = std::make_shared<bool>(false);
+	auto changed = std::make_shared<bool>(false);
+	node.query(
+		dht::InfoHash::get(row.cs),
+		[same, changed, seq = entry.seq](const std::vector<std::shared_ptr<dht::FieldValueIndex>> &fields) {
+			for (const auto &f : fields)
+			{
+				auto it = f->index.find(dht::Value::Field::SeqNum);
+				if (f->index.end() == it)
+					continue;
+				if (seq == it->second.getInt())
+					*same = true;
+				else
+					*changed = true;
+			}
+			return ! *changed; // a changed Config needs a full lookup, there's no point in waiting for more
+		},
+		[&node, &verifier, &window, &retrier, ticket, &row, entry, same, changed](bool) {
+			if (*same && ! *changed)
+			{
+				window.Finish(ticket, [&]() {
+					// 'checked' is left alone, so the Config still gets a full get() once --refresh has passed
+					ApplyCached(entry, row);
+					unchanged++;
+				});
+			}
+			else if (! ticket->expired)
+				Get(node, verifier, window, retrier, ticket, row, 0);
+		},
+		dht::Query(dht::Select().field(dht::Value::Field::SeqNum), w)
+	);
+}
+
+static void Lookup(dht::DhtRunner &node, CVerifier &verifier, CLookupWindow &window, CRetrier &retrier, SHostRow &row)
+{
+	auto ticket = window.Acquire();
+	SHostCacheEntry entry;
+	if (refresh > 0 && cache.Find(row.cs, entry) && now - entry.checked < refresh)
+		CheckSeq(node, verifier, window, retrier, ticket, row, entry);
+	else
+		Get(node, verifier, window, retrier, ticket, row, 0);
+}
+
+// fetch the json file, or read it, and hand each reflector to 'found' as soon as it has been parsed
+// a downloaded file is copied to M17Hosts.json as it arrives, and 'copied' says where it came from
+// a file that hasn't changed since it was saved is only parsed again if 'reparse' is true
+static bool ReadReflectors(CFetcher &fetcher, const std::function<void(json &)> &found, bool reparse, bool &notmodified, std::string &copied)
+{
+	CReflectorSax sax(found);
+	CStreamPipe pipe;
+	std::atomic<bool> stop { false };
+	bool parsed = false;
+	std::thread parser([&]() {
+		std::istream is(&pipe);
+		parsed = json::sax_parse(is, &sax);
+		stop = true; // nothing more will be read, so there's no point in downloading the rest
+	});
+
+	const std::string copyname("M17Hosts.json");
+	const std::string copytmp(copyname + "." + std::to_string(getpid()));
+	std::ofstream copy(copytmp, std::ios::binary | std::ios::trunc);
+	auto feed = [&](const char *data, std::size_t len) {
+		if (stop)
+			return false;
+		pipe.Write(data, len);
+		if (copy.is_open())
+			copy.write(data, len);
+		return true;
+	};
+	CFetcher::SResult fetch;
+	bool fetched = true;
+	const bool remote = (std::string::npos != target.find(":/"));
+	if (remote)
+	{
+		SValidators saved;
+		saved.Load(copyname);
+		fetched = fetcher.Fetch(Split(target), saved, feed, fetch);
+		if (fetched && fetch.notmodified)
+		{
+			// the saved copy is still good, so it is parsed instead, and there is nothing to copy
+			copy.close();
+			unlink(copytmp.c_str());
+			if (reparse)
+				fetched = ReadFile(copyname, feed);
+		}
+		if (fetched)
+			copied.assign("# Copied " + fetch.url + (fetch.notmodified ? ", it hasn't changed since the last run\n" : "\n"));
 	}
-	
-	if (not mref.contains("reflectors"))
+	else if (! ReadFile(target, feed))
 	{
-		std::cerr << "ERROR: " << target << " contains no reflectors" << std::endl;
-		std::cerr << target << " contents:" << std::endl;
-		std::cerr << ss.str() << std::endl;
-		return EXIT_FAILURE;
+		std::cerr << "ERROR: could not open " << target << std::endl;
+		fetched = false;
 	}
+	pipe.Close();
+	parser.join();
+	if (copy.is_open())
+		copy.close();
+	notmodified = fetch.notmodified;
+	if (fetched && notmodified && ! reparse)
+		return true;
 
-	std::ofstream ofile("M17Hosts.json", std::ios::trunc);
-	if (ofile.is_open())
+	// a parse error stops the download, so it is reported instead of the error it causes
+	if (! sax.Error().empty())
+		std::cerr << "ERROR: " << target << " isn't valid json: " << sax.Error() << std::endl;
+	else if (! fetched && remote)
+		std::cerr << "ERROR curling M17 reflectors from " << target << ": " << fetch.error << std::endl;
+	else if (fetched && ! sax.SawReflectors())
+		std::cerr << "ERROR: " << target << " contains no reflectors" << std::endl;
+	if (! fetched || ! parsed || ! sax.SawReflectors())
 	{
-		ofile << ss.rdbuf();
-		ofile.close();
+		unlink(copytmp.c_str());
+		return false;
 	}
+	if (! fetch.notmodified)
+	{
+		// the validators must never describe a different copy than the one that is saved
+		SValidators::Remove(copyname);
+		if (copy.fail() || rename(copytmp.c_str(), copyname.c_str()))
+			unlink(copytmp.c_str());
+		else if (remote)
+			fetch.validators.Save(copyname);
+	}
+	return true;
+}
 
-	std::cout
+// fill in a row that was made from the json file
+static void MakeRowOrSkip(json &ref, SHostRow &row)
+{
+	try {
+		MakeRow(ref, row);
+	} catch (const std::exception &e) {
+		std::cerr << "WARNING: skipping a reflector: " << e.what() << std::endl;
+		row.unknown = true;
+	}
+}
+
+// everything in the host file before the rows
+static std::string Preamble(const std::string &copied)
+{
+	auto t = std::time(nullptr);
+	auto tm = *std::gmtime(&t);
+	std::ostringstream ss;
+	ss
+	<< "# M17 Hosts file generated by " << comname << " V#" << Version << '\n'
+	<< "# Copyright (C) 2024-2026 by Thomas A. Early, N7TAE.\n"
+	<< "# See the LICENSE file in https://github.com/n7tae/dht-ham-tools.\n"
+	<< "# Created on " << std::put_time(&tm, "%Y-%m-%d at %H:%M GMT") << '\n'
+	<< copied
 	<< "# WARNING: Reflectors without a version strings are not using the Ham-DHT and\n"
 	<< "# might have UNKNOWN capabilities and/or incorrect data.\n"
 	<< "# These are input by hand by the admin and might be INCORRECT.\n"
@@ -223,222 +651,571 @@ int main (int argc, char *argv[])
 	<< "# 'Special-modules' for URF reflectors are fully transcoded.\n"
 	<< "#\n"
 	<< "#Reflector;Version;Modules;Special-modules;IPv4-address;IPv6-address;Port;Dashboard-URL\n";
+	return ss.str();
+}
 
-	w.id(toUType(EMrefdValueID::Config));
-	// iterate through reflectors array
-	for (auto &ref : mref["reflectors"])
-	{
-		running = true;
-		got_data = false;
-		std::string cs(ref["designator"].get<std::string>());
-		std::string ipv4(GET_STRING(ref["ipv4"]));
-		std::string ipv6(GET_STRING(ref["ipv6"]));
-		ESource src = ESource::dvref;
-		std::string version;
-		std::string mods, smods;
-		uint16_t port = 17000;
-		std::string url(GET_STRING(ref["url"]));
-		auto keyhash = dht::InfoHash::get(cs);
-		if (0 == cs.substr(0,4).compare("M17-"))
+// the rows of the host file, and the same rows for --hostdb
+static std::string HostRows(const std::deque<SHostRow> &rows, std::vector<CHostDb::SEntry> &entries)
+{
+	std::ostringstream ss;
+	for (const auto &row : rows)
+	{
+		if (row.unknown)
 		{
-			if (ref.contains("modules")) {
-				for (auto &mod : ref["modules"])
-					mods.append(GET_STRING(mod));
-			}
-			if (mods.size() > 1)
-				std::sort(mods.begin(), mods.end());
-			if (ref.contains("encrypted")) {
-				for (auto &mod : ref["encrypted"])
-					smods.append(GET_STRING(mod));
-			}
-			if (smods.size() > 1)
-				std::sort(smods.begin(), smods.end());
-			if (ref.contains("port") and ref["port"].is_number_unsigned())
-				port = ref["port"].get<uint16_t>();
-			mrefdConfig.timestamp = 0;
-			node.get(
-				keyhash,
-				[](const std::shared_ptr<dht::Value> &v) {
-					if (v->checkSignature())
-					{
-						switch (v->id)
-						{
-							case toUType(EMrefdValueID::Config):
-								if (0 == v->user_type.compare(MREFD_CONFIG_1))
-								{
-									got_data = true;
-									auto rdat = dht::Value::unpack<SMrefdConfig1>(*v);
-									if (rdat.timestamp > mrefdConfig.timestamp)
-										mrefdConfig = dht::Value::unpack<SMrefdConfig1>(*v);
-								}
-								break;
-						}
-					}
-					else
-					{
-						std::cerr << "Value signature failed!" << std::endl;
-					}
-					return true;
-				},
-				[](bool success) {
-					if (! success)
-						std::cout << "get() unsuccessful!" << std::endl;
-					std::unique_lock<std::mutex> lck(mtx);
-					running = false;
-					cv.notify_all();
-				},
-				{},	// empty filter
-				w
-			);
-
-			// wait for node.get()
-			std::unique_lock<std::mutex> lck(mtx);
-			while (running)
+			ss << "# Don't know how to parse a '" << row.cs << "' reflector!\n";
+		}
+		if (row.unsuccessful)
+			ss << "get() unsuccessful!\n";
+
+		if (0 == row.port)
+			continue;
+		if (0 == row.ipv4.compare("127.0.0.1") || 0 == row.ipv4.compare("0.0.0.0") || 0 == row.ipv6.compare("::1") || 0 == row.ipv6.compare("::"))
+			continue;
+
+		const std::string url(row.url.compare("https://YourDashboard.net") ? row.url : "");
+
+		if (row.mods.empty())
+			continue;
+
+		ss << row.cs << ';' << row.version << ';' << row.mods << ';' << row.smods << ';' << row.ipv4 << ';' << row.ipv6 << ';' << row.port << ';' << url << '\n';
+		if (hostdb.size())
+			entries.push_back({ row.cs, row.version, row.mods, row.smods, row.ipv4, row.ipv6, url, row.port, ESource::dht == row.src });
+	}
+	return ss.str();
+}
+
+static const char *Footer =
+	"\n\n"
+	"# ################## Direct Routing Targets ##################\n"
+	"#\n"
+	"# You do not link to these target, but you load them the same way you link to a reflector:\n"
+	"# Put the destination in DST and quick-key.\n"
+	"# Capabilities: 2 chars:\n"
+	"# 1. Data handling:\n"
+	"#    'S' if only stream data is processed\n"
+	"#    'P' if only packet data is processed\n"
+	"#    'B' if both packet and stream data is processed\n"
+	"# 2. TYPE handling:\n"
+	"#    'L' if only legacy TYPE format is used\n"
+	"#    '3' if only M17 Specification V#3 TYPE format is used\n"
+	"#    'B' if both formats are understood\n"
+	"# The example shows that N0CALL will only receive Stream data at 44.46.48.201:17100, and uses the legacy TYPE format\n"
+	"# NOCALL:SL;44.46.48.201;;17100\n"
+	"# Destination;Capabilities;IPv4Address;IPv6Address;Port\n";
+
+// the host file goes to stdout, or replaces the output file with AtomicWrite()
+static bool Publish(const std::string &text)
+{
+	if (output.empty())
+	{
+		std::cout << text;
+		std::cout.flush();
+		return true;
+	}
+	return AtomicWrite(output, 0644, { { text.data(), text.size() } });
+}
+
+// Keeps the rows of the host file up to date by listening to the Config of every reflector.
+// A newer Config is applied to its row right away, but the host file is only rewritten once
+// no Config has changed for a while, so a burst of republishes is a single rewrite.
+class CHostFollower
+{
+public:
+	CHostFollower(dht::DhtRunner &n, CVerifier &v) : node(n), verifier(v) {}
+
+	// start with the rows of the first run, 'bases' are the same rows before any lookup
+	void Follow(const std::deque<SHostRow> &rows, const std::deque<SHostRow> &bases);
+	// the rows of a refetched json file, new reflectors are listened to and the ones that are gone are dropped
+	void Update(const std::deque<SHostRow> &bases);
+	// true, with the rows, once something changed and then nothing changed for 'quiet' seconds,
+	// or ten times that long if the changes keep coming
+	bool Settled(std::time_t t, long quiet, std::deque<SHostRow> &rows);
+	// cancel every listen, call this before node.join()
+	void Stop();
+
+	unsigned Updates();
+
+private:
+	struct SFollowed
+	{
+		SHostRow base, row;
+		SLookup values;
+		std::shared_future<size_t> token;
+	};
+
+	std::shared_ptr<SFollowed> Add(const SHostRow &base, std::vector<std::string> &added);
+	void Rebuild(SFollowed &f);
+	void Listen(const std::string &cs);
+	void Changed(const std::string &cs, const dht::Value &v);
+	void Dirty(std::time_t t);
+
+	dht::DhtRunner &node;
+	CVerifier &verifier;
+
+	std::mutex mtx;
+	std::vector<std::shared_ptr<SFollowed>> rows;                // in the order of the json file
+	std::map<std::string, std::shared_ptr<SFollowed>> listened; // by designator
+	bool dirty = false, stopped = false;
+	std::time_t first = 0, last = 0; // when the oldest and the newest unwritten changes happened
+	unsigned updates = 0;
+};
+
+// the row of a reflector in the json file, listened to unless it already is, call this with the lock held
+std::shared_ptr<CHostFollower::SFollowed> CHostFollower::Add(const SHostRow &base, std::vector<std::string> &added)
+{
+	if (base.unknown)
+	{
+		auto f = std::make_shared<SFollowed>();
+		f->base = f->row = base;
+		return f;
+	}
+	auto &f = listened[base.cs];
+	if (! f)
+	{
+		f = std::make_shared<SFollowed>();
+		added.push_back(base.cs);
+	}
+	f->base = base;
+	return f;
+}
+
+// the row is the json file's row with the newest Config on top of it, call this with the lock held
+void CHostFollower::Rebuild(SFollowed &f)
+{
+	f.row = f.base;
+	if (f.values.Has<SMrefdConfig1>() || f.values.Has<SUrfdConfig1>())
+	{
+		Apply(f.values, f.row);
+		return;
+	}
+	// nothing has been heard yet, so use a cached Config if it's young enough, like the first run does
+	SHostCacheEntry entry;
+	if (maxage > 0 && cache.Find(f.base.cs, entry) && std::time(nullptr) - entry.checked <= maxage)
+		ApplyCached(entry, f.row);
+}
+
+void CHostFollower::Follow(const std::deque<SHostRow> &firstrows, const std::deque<SHostRow> &bases)
+{
+	std::vector<std::string> added;
+	{
+		std::lock_guard<std::mutex> lck(mtx);
+		for (std::size_t i=0; i<bases.size(); i++)
+		{
+			auto f = Add(bases[i], added);
+			f->row = firstrows[i];
+			rows.push_back(f);
+		}
+	}
+	// the listens deliver the current values first, which are already in the verifier's cache
+	for (const auto &cs : added)
+		Listen(cs);
+}
+
+void CHostFollower::Update(const std::deque<SHostRow> &bases)
+{
+	std::vector<std::string> added;
+	{
+		std::lock_guard<std::mutex> lck(mtx);
+		auto old = std::move(listened);
+		listened.clear();
+		rows.clear();
+		for (const auto &base : bases)
+		{
+			// a reflector that is still in the json file keeps its values and its listen
+			auto it = old.find(base.cs);
+			if (! base.unknown && old.end() != it && 0 == listened.count(base.cs))
 			{
-				cv.wait(lck);
+				listened.emplace(base.cs, it->second);
+				old.erase(it);
 			}
+			auto f = Add(base, added);
+			Rebuild(*f);
+			rows.push_back(f);
+		}
+		for (auto &item : old)
+		{
+			if (item.second->token.valid())
+				node.cancelListen(dht::InfoHash::get(item.first), item.second->token);
+		}
+		Dirty(std::time(nullptr));
+	}
+	for (const auto &cs : added)
+		Listen(cs);
+}
+
+void CHostFollower::Listen(const std::string &cs)
+{
+	auto token = node.listen(
+		dht::InfoHash::get(cs),
+		[this, cs](const std::vector<std::shared_ptr<dht::Value>> &values, bool expired)
+		{
+			// a Config that expires keeps its row, the reflector is probably just restarting
+			if (expired)
+				return true;
+			for (const auto &v : values)
+				verifier.Check(v, [this, cs](const std::shared_ptr<dht::Value> &v) { Changed(cs, *v); });
+			return true;
+		},
+		{},	// empty filter
+		w
+	).share();
+
+	std::lock_guard<std::mutex> lck(mtx);
+	auto it = listened.find(cs);
+	if (stopped || listened.end() == it)
+		node.cancelListen(dht::InfoHash::get(cs), token);
+	else
+		it->second->token = token;
+}
+
+void CHostFollower::Changed(const std::string &cs, const dht::Value &v)
+{
+	std::lock_guard<std::mutex> lck(mtx);
+	auto it = listened.find(cs);
+	if (listened.end() == it)
+		return;
+	auto &f = *it->second;
+	// a value that arrives late, or again, doesn't change anything
+	if (EAccept::newer != f.values.Accept(v))
+		return;
+	f.values.seq = v.seq;
+	Rebuild(f);
+	if (ESource::dht == f.row.src)
+	{
+		auto entry = ToEntry(f.values, f.row);
+		entry.checked = std::time(nullptr);
+		cache.Store(entry);
+	}
+	updates++;
+	Dirty(std::time(nullptr));
+}
+
+void CHostFollower::Dirty(std::time_t t)
+{
+	if (! dirty)
+		first = t;
+	dirty = true;
+	last = t;
+}
+
+bool CHostFollower::Settled(std::time_t t, long quiet, std::deque<SHostRow> &settled)
+{
+	std::lock_guard<std::mutex> lck(mtx);
+	if (! dirty || (t - last < quiet && t - first < 10 * quiet))
+		return false;
+	dirty = false;
+	settled.clear();
+	for (const auto &f : rows)
+		settled.push_back(f->row);
+	return true;
+}
+
+void CHostFollower::Stop()
+{
+	std::lock_guard<std::mutex> lck(mtx);
+	stopped = true;
+	for (auto &item : listened)
+	{
+		if (item.second->token.valid())
+			node.cancelListen(dht::InfoHash::get(item.first), item.second->token);
+	}
+}
+
+unsigned CHostFollower::Updates()
+{
+	std::lock_guard<std::mutex> lck(mtx);
+	return updates;
+}
+
+int main (int argc, char *argv[])
+{
+	const auto start = CStats::Clock::now();
+	comname.assign(argv[0]);
+	unsigned inflight = default_window;
+	unsigned timeout = default_timeout;
+	unsigned tries = default_retries;
+	SNodeOptions nodeopts;
+	static const struct option long_options[] = {
+		{ "identity",  required_argument, nullptr, OPT_IDENTITY  },
+		{ "ephemeral", no_argument,       nullptr, OPT_EPHEMERAL },
+		{ "gateway",   required_argument, nullptr, OPT_GATEWAY   },
+		{ "stats",     no_argument,       nullptr, OPT_STATS     },
+		{ "refresh",   required_argument, nullptr, OPT_REFRESH   },
+		{ "max-age",   required_argument, nullptr, OPT_MAXAGE    },
+		{ "hostdb",    required_argument, nullptr, OPT_HOSTDB    },
+		{ "daemon",    no_argument,       nullptr, OPT_DAEMON    },
+		{ "interval",  required_argument, nullptr, OPT_INTERVAL  },
+		{ "debounce",  required_argument, nullptr, OPT_DEBOUNCE  },
+		{ "ready-nodes", required_argument, nullptr, OPT_READYNODES },
+		{ "ready-wait",  required_argument, nullptr, OPT_READYWAIT  },
+		{ nullptr, 0, nullptr, 0 }
+	};
+	while (1)
+	{
+		int c = getopt_long(argc, argv, "j:o:r:t:", long_options, nullptr);
+		if (c < 0)
+			break;
+
+		switch (c)
+		{
+			case OPT_STATS:
+			stats.Enable();
+			break;
+
+			case OPT_REFRESH:
+			refresh = std::strtol(optarg, nullptr, 10);
+			break;
+
+			case OPT_MAXAGE:
+			maxage = std::strtol(optarg, nullptr, 10);
+			break;
+
+			case OPT_HOSTDB:
+			hostdb.assign(optarg);
+			break;
 
-			if (got_data)
+			case OPT_DAEMON:
+			follow = true;
+			break;
+
+			case OPT_INTERVAL:
+			interval = std::strtol(optarg, nullptr, 10);
+			break;
+
+			case OPT_DEBOUNCE:
+			debounce = std::strtol(optarg, nullptr, 10);
+			break;
+
+			case 'o':
+			output.assign(optarg);
+			break;
+
+			case 'r':
+			tries = std::strtoul(optarg, nullptr, 10);
+			break;
+
+			case 'j':
+			inflight = std::strtoul(optarg, nullptr, 10);
+			if (0 == inflight)
 			{
-				version.assign(mrefdConfig.version);
-				if (mrefdConfig.ipv4addr.size())
-					ipv4.assign(mrefdConfig.ipv4addr);
-				if (mrefdConfig.ipv6addr.size())
-					ipv6.assign(mrefdConfig.ipv6addr);
-				if (mrefdConfig.modules.size())
-					mods.assign(mrefdConfig.modules);
-				if (mrefdConfig.encryptedmods.size())
-					smods.assign(mrefdConfig.encryptedmods);
-				if (mrefdConfig.url.size())
-					url.assign(mrefdConfig.url);
-				port = mrefdConfig.port;
-				src = ESource::dht;
+				std::cerr << comname << ": -j must be at least 1!" << std::endl;
+				Usage(std::cerr);
+				return EXIT_FAILURE;
 			}
+			break;
+
+			case 't':
+			timeout = std::strtoul(optarg, nullptr, 10);
+			break;
+
+			case OPT_IDENTITY:
+			nodeopts.statedir.assign(optarg);
+			break;
+
+			case OPT_EPHEMERAL:
+			nodeopts.ephemeral = true;
+			break;
+
+			case OPT_GATEWAY:
+			nodeopts.gateway.assign(optarg);
+			break;
+
+			case OPT_READYNODES:
+			nodeopts.readynodes = std::strtoul(optarg, nullptr, 10);
+			break;
+
+			case OPT_READYWAIT:
+			nodeopts.readywait = std::strtod(optarg, nullptr);
+			break;
+
+			default:
+			Usage(std::cerr);
+			return EXIT_FAILURE;
+		}
+	}
+
+	switch (argc - optind)
+	{
+		case 0:
+			Usage(std::cout);
+			return EXIT_SUCCESS;
+		case 1:
+			target.assign(argv[optind]);
+			break;
+		case 2:
+			target.assign(argv[optind]);
+			hostname.assign(argv[optind+1]);
+			break;
+		default:
+			Usage(std::cerr);
+			return EXIT_FAILURE;
+	}
+
+	if (follow && output.empty())
+	{
+		std::cerr << comname << ": --daemon needs -o file!" << std::endl;
+		Usage(std::cerr);
+		return EXIT_FAILURE;
+	}
+
+	// a daemon blocks these before the node starts its threads, so only sigtimedwait() will see them
+	sigset_t sigs;
+	sigemptyset(&sigs);
+	sigaddset(&sigs, SIGINT);
+	sigaddset(&sigs, SIGTERM);
+	if (follow)
+		pthread_sigmask(SIG_BLOCK, &sigs, nullptr);
+
+	// boot up the Ham-DTH
+	CRetrier retrier(tries);
+	CVerifier verifier;	// declared first, so it outlives the node's callbacks
+	dht::DhtRunner node;
+	try {
+		RunNode(node, "GetM17Hosts", hostname, nodeopts);
+		verifier.Load(nodeopts.statedir);
+		cache.Load(nodeopts.statedir);
+	} catch (const std::exception &ex) {
+		std::cout << argv[0] << " can't connect to the Ham-DHT! " << ex.what() << std::endl;
+		return 1;
+	}
+
+	stats.Phase("identity", nodeopts.idmsecs);
+	stats.Phase("bootstrap", nodeopts.readymsecs);
+
+	// the reflectors are looked up as soon as each one is parsed, while the rest of the file is still arriving
+	auto phase = stats.Start();
+	now = std::time(nullptr);
+	w.id(toUType(EMrefdValueID::Config));
+	std::deque<SHostRow> rows;  // a lookup holds a reference to its row, so rows can't move
+	std::deque<SHostRow> bases; // the same rows before the lookups, for --daemon
+	CLookupWindow window(inflight, std::chrono::seconds(timeout));
+	CFetcher fetcher(std::string("Ham-DHT/") + Version);
+	std::string copied;
+	bool notmodified;
+	const bool ok = ReadReflectors(fetcher, [&](json &ref) {
+		rows.emplace_back();
+		auto &row = rows.back();
+		MakeRowOrSkip(ref, row);
+		if (follow)
+			bases.push_back(row);
+		if (! row.unknown)
+			Lookup(node, verifier, window, retrier, row);
+	}, true, notmodified, copied);
+	stats.Phase("fetch", phase);
+	if (! ok)
+	{
+		// the lookups that already started must not outlive the window
+		retrier.Stop();
+		node.join();
+		verifier.Stop();
+		return EXIT_FAILURE;
+	}
+
+	window.WaitAll();
+	retrier.Stop();
+	stats.Phase("lookups", phase);
+	if (window.Abandoned())
+		std::cerr << window.Abandoned() << " lookup(s) took longer than " << timeout << " seconds and were abandoned" << std::endl;
+	if (retrier.Retries())
+	{
+		unsigned missing = 0;
+		for (const auto &row : rows)
+		{
+			if (! row.unknown && ESource::dht != row.src)
+				missing++;
 		}
-		else if (0 == cs.substr(0,3).compare("URF"))
+		std::cerr << retrier.Retries() << " lookup(s) were retried, " << missing << " reflector(s) still weren't found on the Ham-DHT" << std::endl;
+	}
+	if (fallbacks)
+		std::cerr << fallbacks << " reflector(s) weren't found, so their cached Config was used" << std::endl;
+
+	phase = stats.Start();
+	std::vector<CHostDb::SEntry> entries; // the same rows as the host file, for --hostdb
+	auto body = HostRows(rows, entries);
+	if (! Publish(Preamble(copied) + body + Footer))
+		std::cerr << "ERROR: could not write " << output << std::endl;
+	if (hostdb.size() && ! CHostDb::Write(hostdb, entries))
+		std::cerr << "ERROR: could not write " << hostdb << std::endl;
+	stats.Phase("output", phase);
+
+	verifier.Save();
+	cache.Save();
+	SaveNodes(node, nodeopts);
+
+	// declared out here, so it outlives node.join() and verifier.Stop(), which can still call it back
+	CHostFollower follower(node, verifier);
+	if (follow)
+	{
+		// the first run is done, now the host file follows the Ham-DHT and the json file
+		follower.Follow(rows, bases);
+		std::cout << "Following " << rows.size() << " reflectors into " << output << std::endl;
+		auto nextfetch = std::time(nullptr) + interval;
+		auto nextsave = std::time(nullptr) + save_interval;
+		const struct timespec tick { 1, 0 };
+		while (sigtimedwait(&sigs, nullptr, &tick) < 0)
 		{
-			// fish out the modules and transcoded modules
-			if (ref.contains("modules"))
+			const auto t = std::time(nullptr);
+			if (interval > 0 && t >= nextfetch)
 			{
-				for (auto &mod : ref["modules"])
+				nextfetch = t + interval;
+				std::deque<SHostRow> fresh;
+				std::string c;
+				if (ReadReflectors(fetcher, [&fresh](json &ref) { fresh.emplace_back(); MakeRowOrSkip(ref, fresh.back()); }, false, notmodified, c) && ! notmodified)
 				{
-					auto m = mod["module"].get<std::string>();
-					const std::string mode(GET_STRING(mod["mode"]));
-					if (0==mode.compare("All") or 0==mode.compare("M17"))
-					{
-						mods.append(m);
-						if (mod["transcode"].is_boolean())
-						{
-							if (mod["transcode"].get<bool>())
-								smods.append(m);
-						}
-						if (0 == mode.compare("M17"))
-						{
-							if (mod["port"].is_number_unsigned())
-								port = mod["port"].get<uint16_t>();
-						}
-					}
+					copied.assign(c);
+					follower.Update(fresh);
 				}
 			}
-			url.assign(GET_STRING(ref["url"]));
-			auto keyhash = dht::InfoHash::get(cs);
-			urfdConfig.timestamp = 0;
-			node.get(
-				keyhash,
-				[](const std::shared_ptr<dht::Value> &v) {
-					if (v->checkSignature())
-					{
-						switch (v->id)
-						{
-						case toUType(EUrfdValueID::Config):
-							if (0 == v->user_type.compare(URFD_CONFIG_1))
-							{
-								got_data = true;
-								auto rdat = dht::Value::unpack<SUrfdConfig1>(*v);
-								if (rdat.timestamp > urfdConfig.timestamp)
-									urfdConfig = dht::Value::unpack<SUrfdConfig1>(*v);
-							}
-						}
-					}
+
+			// nothing is written unless a row of the host file is different
+			std::deque<SHostRow> settled;
+			if (follower.Settled(t, debounce, settled))
+			{
+				entries.clear();
+				auto text = HostRows(settled, entries);
+				if (text != body)
+				{
+					if (! Publish(Preamble(copied) + text + Footer))
+						std::cerr << "ERROR: could not write " << output << std::endl;
 					else
 					{
-						std::cerr << "Value signature failed!" << std::endl;
+						body.swap(text);
+						std::cout << "Rewrote " << output << " after " << follower.Updates() << " Config update(s)" << std::endl;
 					}
-					return true;
-				},
-				[](bool success) {
-					if (! success)
-						std::cout << "get() unsuccessful!" << std::endl;
-					std::unique_lock<std::mutex> lck(mtx);
-					running = false;
-					cv.notify_all();
-				},
-				{},	// empty filter
-				w
-			);
-
-			// wait for node.get()
-			std::unique_lock<std::mutex> lck(mtx);
-			while (running)
-			{
-				cv.wait(lck);
+					if (hostdb.size() && ! CHostDb::Write(hostdb, entries))
+						std::cerr << "ERROR: could not write " << hostdb << std::endl;
+				}
 			}
 
-			if (got_data)
+			// so even a daemon that is killed restarts warm
+			if (t >= nextsave)
 			{
-				version.assign(urfdConfig.version);
-				if (urfdConfig.ipv4addr.size())
-					ipv4.assign(urfdConfig.ipv4addr);
-				if (urfdConfig.ipv6addr.size())
-					ipv6.assign(urfdConfig.ipv6addr);
-				if (urfdConfig.modules.size())
-					mods.assign(urfdConfig.modules);
-				if (urfdConfig.transcodedmods.size())
-					smods.assign(urfdConfig.transcodedmods);
-				port = urfdConfig.port[toUType(EUrfdPorts::m17)];
-				src = ESource::dht;
-				if (urfdConfig.url.size())
-					url.assign(urfdConfig.url);
+				nextsave = t + save_interval;
+				verifier.Save();
+				cache.Save();
+				SaveNodes(node, nodeopts);
 			}
 		}
-		else
-		{
-			std::cout << "# Don't know how to parse a '" << cs << "' reflector!" << std::endl;
-		}
-
-		if (0 == port)
-			continue;
-		if (0 == ipv4.compare("127.0.0.1") || 0 == ipv4.compare("0.0.0.0") || 0 == ipv6.compare("::1") || 0 == ipv6.compare("::"))
-			continue;
-
-		if (0 == url.compare("https://YourDashboard.net"))
-			url.clear();
-
-		if (mods.empty())
-			continue;
-
-		std::cout << cs << ';' << version << ';' << mods << ';' << smods << ';' << ipv4 << ';' << ipv6 << ';' << port << ';' << url << '\n';
+		follower.Stop();
+		verifier.Save();
+		cache.Save();
+		SaveNodes(node, nodeopts);
 	}
 
 	node.join(); // disconnect from the Ham-DHT
+	verifier.Stop(); // an abandoned lookup, or the follower, may still be waiting on it
 
-	std::cout << "\n\n"
-	<< "# ################## Direct Routing Targets ##################\n"
-	<< "#\n"
-	<< "# You do not link to these target, but you load them the same way you link to a reflector:\n"
-	<< "# Put the destination in DST and quick-key.\n"
-	<< "# Capabilities: 2 chars:\n"
-	<< "# 1. Data handling:\n"
-	<< "#    'S' if only stream data is processed\n"
-	<< "#    'P' if only packet data is processed\n"
-	<< "#    'B' if both packet and stream data is processed\n"
-	<< "# 2. TYPE handling:\n"
-	<< "#    'L' if only legacy TYPE format is used\n"
-	<< "#    '3' if only M17 Specification V#3 TYPE format is used\n"
-	<< "#    'B' if both formats are understood\n"
-	<< "# The example shows that N0CALL will only receive Stream data at 44.46.48.201:17100, and uses the legacy TYPE format\n"
-	<< "# NOCALL:SL;44.46.48.201;;17100\n"
-	<< "# Destination;Capabilities;IPv4Address;IPv6Address;Port\n";
+	stats.Count("good_nodes", nodeopts.goodnodes);
+	stats.Count("reflectors", rows.size());
+	stats.Count("signatures_cached", verifier.Hits());
+	stats.Count("signatures_verified", verifier.Misses());
+	stats.Count("signatures_failed", verifier.Failures());
+	stats.Count("retries", retrier.Retries());
+	stats.Count("abandoned", window.Abandoned());
+	stats.Count("cache_unchanged", unchanged);
+	stats.Count("cache_fallbacks", fallbacks);
+	stats.Phase("total", start);
+	stats.Write(std::cerr);
 
 	return EXIT_SUCCESS;
 }